@@ -0,0 +1,101 @@
+#include "band_executor.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace merle {
+
+BandExecutor::BandExecutor(size_t cache_size, uint32_t thread_count)
+    : cache_size_(cache_size),
+      thread_count_(thread_count != 0u
+                        ? thread_count
+                        : std::max(std::thread::hardware_concurrency(), 1u)) {}
+
+uint32_t BandExecutor::GetBandHeight(const OpChain& chain,
+                                     uint32_t width) const {
+  const uint64_t halo_rows = 2u * chain.GetHalo();
+  // The band and the scratch texture each hold every row of the band.
+  const uint64_t row_bytes = 2u * sizeof(Color) * std::max(width, 1u);
+  const uint64_t rows = cache_size_ / row_bytes;
+  const uint64_t band_height = rows > halo_rows ? rows - halo_rows : 0u;
+  return static_cast<uint32_t>(std::clamp<uint64_t>(
+      band_height, std::max<uint64_t>(chain.GetHalo(), 1u), UINT32_MAX));
+}
+
+bool BandExecutor::Run(const OpChain& chain,
+                       const Texture& src,
+                       Texture& dst) const {
+  if (&src == &dst || src.GetSize() != dst.GetSize()) {
+    return false;
+  }
+  const auto size = src.GetSize();
+  if (size.GetArea() == 0u) {
+    return true;
+  }
+  const auto halo = chain.GetHalo();
+  const auto band_height = std::min(GetBandHeight(chain, size.x), size.y);
+  const auto band_count = (size.y + band_height - 1u) / band_height;
+
+  // Make the planes of the destination unique here so that the threads below
+  // don't all try to at once.
+  if (!dst.MakePlanesUnique(kComponents)) {
+    return false;
+  }
+  std::array<const uint8_t*, 4u> src_planes;
+  std::array<uint8_t*, 4u> dst_planes;
+  for (size_t i = 0; i < kComponents.size(); i++) {
+    src_planes[i] = src.GetAllocation(kComponents[i]);
+    dst_planes[i] = dst.GetAllocationMutable(kComponents[i]);
+  }
+
+  std::atomic<uint32_t> next_band = 0u;
+  std::atomic<bool> success = true;
+  auto run_bands = [&]() {
+    Texture band;
+    Texture scratch;
+    for (auto index = next_band++; index < band_count && success;
+         index = next_band++) {
+      const uint32_t top = index * band_height;
+      const uint32_t bottom = std::min(top + band_height, size.y);
+      const uint32_t read_top = top > halo ? top - halo : 0u;
+      const uint32_t read_bottom = static_cast<uint32_t>(
+          std::min<uint64_t>(static_cast<uint64_t>(bottom) + halo, size.y));
+      if (!band.Resize({size.x, read_bottom - read_top}) ||
+          !band.MakePlanesUnique(kComponents)) {
+        success = false;
+        break;
+      }
+      for (size_t i = 0; i < kComponents.size(); i++) {
+        ::memcpy(band.GetAllocationMutable(kComponents[i]),
+                 src_planes[i] + static_cast<size_t>(read_top) * size.x,
+                 band.GetPixelCount());
+      }
+      if (!chain.Run(band, scratch)) {
+        success = false;
+        break;
+      }
+      for (size_t i = 0; i < kComponents.size(); i++) {
+        ::memcpy(dst_planes[i] + static_cast<size_t>(top) * size.x,
+                 band.GetAllocation(kComponents[i], {0u, top - read_top}),
+                 static_cast<size_t>(bottom - top) * size.x);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  const auto thread_count = std::min(thread_count_, band_count);
+  for (uint32_t i = 1u; i < thread_count; i++) {
+    threads.emplace_back(run_bands);
+  }
+  run_bands();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return success;
+}
+
+}  // namespace merle
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "macros.h"
+#include "op_chain.h"
+#include "texture.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      Runs an op chain over a texture in horizontal bands small
+///             enough for a band and its scratch texture to stay in the cache.
+///
+///             Running the ops of a chain one after another on a whole texture
+///             goes through memory once per op. Here, each band is copied into
+///             a scratch texture along with the halo rows the neighborhood ops
+///             of the chain need, the whole chain is run on it while it's hot
+///             and only the finished rows are written back. Bands are spread
+///             across threads.
+///
+///             The result is the same as running the chain on the whole
+///             texture.
+///
+class BandExecutor {
+ public:
+  // A conservative guess at the size of the cache closest to each core that
+  // isn't tiny.
+  static constexpr size_t kDefaultCacheSize = 1u << 20u;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Create an executor.
+  ///
+  /// @param[in]  cache_size    The number of bytes a band and its scratch
+  ///                           texture should fit in.
+  /// @param[in]  thread_count  The number of threads to run bands on. Zero
+  ///                           picks one per hardware thread.
+  ///
+  explicit BandExecutor(size_t cache_size = kDefaultCacheSize,
+                        uint32_t thread_count = 0u);
+
+  ~BandExecutor() = default;
+
+  //----------------------------------------------------------------------------
+  /// @brief      The number of finished rows each band produces for textures
+  ///             of the given width. Bands are never shorter than the halo of
+  ///             the chain, which caps the work spent on halo rows.
+  ///
+  uint32_t GetBandHeight(const OpChain& chain, uint32_t width) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Run the chain on the source and write the result to the
+  ///             destination.
+  ///
+  /// @param[in]  chain  The chain to run.
+  /// @param[in]  src    The source. Left untouched.
+  /// @param      dst    The destination. Must be the same size as the source
+  ///                    but a different texture.
+  ///
+  /// @return     If the chain succeeded on every band.
+  ///
+  bool Run(const OpChain& chain, const Texture& src, Texture& dst) const;
+
+ private:
+  const size_t cache_size_;
+  const uint32_t thread_count_;
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(BandExecutor);
+};
+
+}  // namespace merle
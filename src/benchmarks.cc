@@ -1,11 +1,35 @@
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "band_executor.h"
+#include "blit_batch.h"
 #include "benchmark/benchmark.h"
+#include "formatted_texture.h"
 #include "geom.h"
+#include "op_chain.h"
+#include "packed_texture.h"
+#include "path.h"
+#include "path_rasterizer.h"
+#include "rasterizer.h"
+#include "remap_table.h"
+#include "rgb565_texture.h"
+#include "shared_texture.h"
+#include "streaming_executor.h"
 #include "texture.h"
+#include "texture_batch.h"
+#include "tiled_texture.h"
 
 namespace merle {
 
 static constexpr UPoint kBenchmarkCanvasSize = {1 << 14, 1 << 14};
 
+// The same number of pixels as the benchmark canvas in thumbnails.
+static constexpr UPoint kThumbnailSize = {256u, 256u};
+static constexpr uint32_t kThumbnailCount =
+    (kBenchmarkCanvasSize.x / kThumbnailSize.x) *
+    (kBenchmarkCanvasSize.y / kThumbnailSize.y);
+
 static void DoNothing(benchmark::State& state) {
   while (state.KeepRunning()) {
     //
@@ -34,6 +58,433 @@ static void ToRGBA(benchmark::State& state) {
 }
 BENCHMARK(ToRGBA)->Unit(benchmark::TimeUnit::kMillisecond);
 
+static void ToRGB565(benchmark::State& state) {
+  Texture texture;
+  RGB565Texture rgb565;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(rgb565.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorBlue);
+  while (state.KeepRunning()) {
+    rgb565.CopyFromTexture(texture);
+  }
+}
+BENCHMARK(ToRGB565)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void ToRGB565Dithered(benchmark::State& state) {
+  Texture texture;
+  RGB565Texture rgb565;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(rgb565.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorBlue);
+  while (state.KeepRunning()) {
+    rgb565.CopyFromTexture(texture, true);
+  }
+}
+BENCHMARK(ToRGB565Dithered)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void DecodeSRGB(benchmark::State& state) {
+  Texture texture;
+  FormattedTexture linear(kPixelFormatRGBA16);
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(linear.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorFuchsia);
+  while (state.KeepRunning()) {
+    linear.DecodeFromTexture(texture);
+  }
+}
+BENCHMARK(DecodeSRGB)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void EncodeSRGB(benchmark::State& state) {
+  Texture texture;
+  FormattedTexture linear(kPixelFormatRGBA16);
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(linear.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorFuchsia);
+  MERLE_ASSERT(linear.DecodeFromTexture(texture));
+  while (state.KeepRunning()) {
+    linear.EncodeToTexture(texture);
+  }
+}
+BENCHMARK(EncodeSRGB)->Unit(benchmark::TimeUnit::kMillisecond);
+
+// The canvas down to a thumbnail and 4K UHD down to 1080p.
+static constexpr UPoint kResampleThumbnailSize = {256u, 256u};
+static constexpr UPoint k4KSize = {3840u, 2160u};
+static constexpr UPoint k1080pSize = {1920u, 1080u};
+
+static void RunResample(benchmark::State& state,
+                        UPoint src_size,
+                        UPoint dst_size,
+                        Texture::ResampleFilter filter) {
+  Texture src;
+  Texture dst;
+  MERLE_ASSERT(src.Resize(src_size));
+  MERLE_ASSERT(dst.Resize(dst_size));
+  src.Clear(kColorFuchsia);
+  while (state.KeepRunning()) {
+    src.Resample(dst, filter);
+  }
+}
+
+static void ResampleAreaToThumbnail(benchmark::State& state) {
+  RunResample(state, kBenchmarkCanvasSize, kResampleThumbnailSize,
+              Texture::ResampleFilter::kArea);
+}
+BENCHMARK(ResampleAreaToThumbnail)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void ResampleLanczosToThumbnail(benchmark::State& state) {
+  RunResample(state, kBenchmarkCanvasSize, kResampleThumbnailSize,
+              Texture::ResampleFilter::kLanczos3);
+}
+BENCHMARK(ResampleLanczosToThumbnail)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void ResampleBicubic4KTo1080p(benchmark::State& state) {
+  RunResample(state, k4KSize, k1080pSize, Texture::ResampleFilter::kBicubic);
+}
+BENCHMARK(ResampleBicubic4KTo1080p)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static constexpr uint32_t kPyramidLevels = 10u;
+
+static void PyramidByHalving(benchmark::State& state) {
+  Texture texture;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorFuchsia);
+  while (state.KeepRunning()) {
+    std::vector<Texture> pyramid;
+    pyramid.push_back(texture.Clone());
+    for (uint32_t i = 1u; i < kPyramidLevels; i++) {
+      const auto size = pyramid.back().GetSize();
+      Texture level;
+      MERLE_ASSERT(level.Resize({size.x / 2u, size.y / 2u}));
+      pyramid.back().Resample(level, Texture::ResampleFilter::kArea);
+      pyramid.push_back(std::move(level));
+    }
+  }
+}
+BENCHMARK(PyramidByHalving)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void BuildPyramid(benchmark::State& state) {
+  Texture texture;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorFuchsia);
+  while (state.KeepRunning()) {
+    texture.BuildPyramid(kPyramidLevels);
+  }
+}
+BENCHMARK(BuildPyramid)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void RunWarp(benchmark::State& state, const Transform& transform) {
+  Texture src;
+  Texture dst;
+  MERLE_ASSERT(src.Resize(k4KSize));
+  MERLE_ASSERT(dst.Resize(k4KSize));
+  src.Clear(kColorFuchsia);
+  while (state.KeepRunning()) {
+    dst.Warp(src, transform);
+  }
+}
+
+static void WarpRotate(benchmark::State& state) {
+  // Deskew a scan by a few degrees about its center.
+  const auto center = Transform::MakeTranslation(k4KSize.x / 2.0f,  //
+                                                 k4KSize.y / 2.0f);
+  RunWarp(state, center * Transform::MakeRotation(Degrees(7.0f)) *
+                     *center.Invert());
+}
+BENCHMARK(WarpRotate)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void WarpPerspective(benchmark::State& state) {
+  const PointF size = {static_cast<ScalarF>(k4KSize.x),
+                       static_cast<ScalarF>(k4KSize.y)};
+  const auto transform = Transform::MakeQuadToQuad(
+      {PointF{0.0f, 0.0f}, {size.x, 0.0f}, size, {0.0f, size.y}},
+      {PointF{size.x * 0.1f, size.y * 0.05f},
+       {size.x * 0.95f, 0.0f},
+       size,
+       {0.0f, size.y * 0.9f}});
+  MERLE_ASSERT(transform.has_value());
+  RunWarp(state, *transform);
+}
+BENCHMARK(WarpPerspective)->Unit(benchmark::TimeUnit::kMillisecond);
+
+// Undoes barrel distortion about the center of a 4K frame.
+static PointF Undistort(PointF point) {
+  const PointF center = {k4KSize.x / 2.0f, k4KSize.y / 2.0f};
+  const PointF offset = {(point.x - center.x) / center.x,
+                         (point.y - center.y) / center.x};
+  const auto radius = std::sqrt(offset.x * offset.x + offset.y * offset.y);
+  const auto scale = std::atan(radius * 0.8f) / (radius * 0.8f + 1e-6f);
+  return {center.x + offset.x * scale * center.x,
+          center.y + offset.y * scale * center.x};
+}
+
+static void BuildRemapTable(benchmark::State& state) {
+  RemapTable table;
+  while (state.KeepRunning()) {
+    table.Build(k4KSize, k4KSize, Undistort);
+  }
+}
+BENCHMARK(BuildRemapTable)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void RemapUndistort(benchmark::State& state) {
+  Texture src;
+  Texture dst;
+  RemapTable table;
+  MERLE_ASSERT(src.Resize(k4KSize));
+  MERLE_ASSERT(dst.Resize(k4KSize));
+  MERLE_ASSERT(table.Build(k4KSize, k4KSize, Undistort));
+  src.Clear(kColorFuchsia);
+  while (state.KeepRunning()) {
+    dst.Remap(src, table);
+  }
+}
+BENCHMARK(RemapUndistort)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void Rotate90(benchmark::State& state) {
+  Texture src;
+  Texture dst;
+  MERLE_ASSERT(src.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(dst.Resize({kBenchmarkCanvasSize.y, kBenchmarkCanvasSize.x}));
+  src.Clear(kColorFuchsia);
+  while (state.KeepRunning()) {
+    dst.Rotate90(src);
+  }
+}
+BENCHMARK(Rotate90)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void Rotate180(benchmark::State& state) {
+  Texture src;
+  Texture dst;
+  MERLE_ASSERT(src.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(dst.Resize(kBenchmarkCanvasSize));
+  src.Clear(kColorFuchsia);
+  while (state.KeepRunning()) {
+    dst.Rotate180(src);
+  }
+}
+BENCHMARK(Rotate180)->Unit(benchmark::TimeUnit::kMillisecond);
+
+// What the rotations and flips are up against.
+static void CopyPlanes(benchmark::State& state) {
+  Texture src;
+  Texture dst;
+  MERLE_ASSERT(src.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(dst.Resize(kBenchmarkCanvasSize));
+  src.Clear(kColorFuchsia);
+  while (state.KeepRunning()) {
+    ::memcpy(dst.GetContiguousAllocationMutable(), src.GetAllocation(),
+             src.GetPixelCount() * src.GetBytesPerPixel());
+  }
+}
+BENCHMARK(CopyPlanes)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void RunComposite(benchmark::State& state,
+                         Texture::CompositeMode mode,
+                         AlphaType alpha_type) {
+  Texture src;
+  Texture dst;
+  MERLE_ASSERT(src.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(dst.Resize(kBenchmarkCanvasSize));
+  src.Clear(kColorFuchsia.WithAlpha(128));
+  dst.Clear(kColorBlue);
+  while (state.KeepRunning()) {
+    dst.Composite(src, {}, mode, 0.75f, alpha_type);
+  }
+}
+
+static void CompositeSrcOver(benchmark::State& state) {
+  RunComposite(state, Texture::CompositeMode::kSrcOver, AlphaType::kStraight);
+}
+BENCHMARK(CompositeSrcOver)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void CompositeSrcOverPremultiplied(benchmark::State& state) {
+  RunComposite(state, Texture::CompositeMode::kSrcOver,
+               AlphaType::kPremultiplied);
+}
+BENCHMARK(CompositeSrcOverPremultiplied)
+    ->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void CompositeXorPremultiplied(benchmark::State& state) {
+  RunComposite(state, Texture::CompositeMode::kXor, AlphaType::kPremultiplied);
+}
+BENCHMARK(CompositeXorPremultiplied)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void RunBlend(benchmark::State& state, Texture::BlendMode mode) {
+  Texture top;
+  Texture canvas;
+  MERLE_ASSERT(top.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(canvas.Resize(kBenchmarkCanvasSize));
+  top.Clear(kColorFuchsia.WithAlpha(128));
+  canvas.Clear(kColorBlue);
+  while (state.KeepRunning()) {
+    canvas.Blend(canvas, top, mode, 0.75f);
+  }
+}
+
+static void BlendMultiply(benchmark::State& state) {
+  RunBlend(state, Texture::BlendMode::kMultiply);
+}
+BENCHMARK(BlendMultiply)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void BlendSoftLight(benchmark::State& state) {
+  RunBlend(state, Texture::BlendMode::kSoftLight);
+}
+BENCHMARK(BlendSoftLight)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static constexpr uint32_t kBlendLayerCount = 20u;
+
+// Flattens a stack of 1080p layers onto a canvas, cycling through the modes.
+static void BlendLayers(benchmark::State& state) {
+  std::vector<Texture> layers(kBlendLayerCount);
+  for (uint32_t i = 0; i < kBlendLayerCount; i++) {
+    MERLE_ASSERT(layers[i].Resize(k1080pSize));
+    layers[i].Clear(Color(i * 12u, 255u - i * 12u, i * 7u, 64u + i * 8u));
+  }
+  Texture canvas;
+  MERLE_ASSERT(canvas.Resize(k1080pSize));
+  constexpr auto kModeCount =
+      static_cast<uint32_t>(Texture::BlendMode::kExclusion) + 1u;
+  while (state.KeepRunning()) {
+    canvas.Clear(kColorWhite);
+    for (uint32_t i = 0; i < kBlendLayerCount; i++) {
+      canvas.Blend(canvas, layers[i],
+                   static_cast<Texture::BlendMode>(i % kModeCount));
+    }
+  }
+}
+BENCHMARK(BlendLayers)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static constexpr uint32_t kSpriteCount = 4096u;
+static constexpr int32_t kSpriteSize = 32;
+
+// An atlas of a row of icons and where to put each of the sprites on a 1080p
+// canvas.
+static Texture MakeSpriteAtlas() {
+  Texture atlas;
+  MERLE_ASSERT(atlas.Resize({kSpriteSize * 8u, kSpriteSize}));
+  atlas.Clear(kColorFuchsia.WithAlpha(192));
+  return atlas;
+}
+
+static Point GetSpritePoint(uint32_t i) {
+  return {static_cast<int32_t>((i * 397u) % (k1080pSize.x - kSpriteSize)),
+          static_cast<int32_t>((i * 211u) % (k1080pSize.y - kSpriteSize))};
+}
+
+static void ReplaceSprites(benchmark::State& state) {
+  const auto atlas = MakeSpriteAtlas();
+  std::vector<Texture> icons(8u);
+  for (uint32_t i = 0; i < icons.size(); i++) {
+    MERLE_ASSERT(icons[i].Resize({kSpriteSize, kSpriteSize}));
+    icons[i].Replace(atlas, {-kSpriteSize * static_cast<int32_t>(i), 0});
+  }
+  Texture canvas;
+  MERLE_ASSERT(canvas.Resize(k1080pSize));
+  while (state.KeepRunning()) {
+    for (uint32_t i = 0; i < kSpriteCount; i++) {
+      canvas.Replace(icons[i % icons.size()], GetSpritePoint(i));
+    }
+  }
+}
+BENCHMARK(ReplaceSprites)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void BlitBatchSprites(benchmark::State& state) {
+  const auto atlas = MakeSpriteAtlas();
+  Texture canvas;
+  MERLE_ASSERT(canvas.Resize(k1080pSize));
+  BlitBatch batch;
+  while (state.KeepRunning()) {
+    batch.Clear();
+    for (uint32_t i = 0; i < kSpriteCount; i++) {
+      batch.Add(Rect{static_cast<int32_t>(i % 8u) * kSpriteSize, 0,
+                     kSpriteSize, kSpriteSize},
+                GetSpritePoint(i), 0.75f);
+    }
+    batch.Draw(atlas, canvas);
+  }
+}
+BENCHMARK(BlitBatchSprites)->Unit(benchmark::TimeUnit::kMillisecond);
+
+// A frame of user interface: panels, buttons, dots and a chart filled onto a
+// 1080p canvas.
+static void RasterizeShapes(benchmark::State& state) {
+  Texture canvas;
+  MERLE_ASSERT(canvas.Resize(k1080pSize));
+  Rasterizer rasterizer(k1080pSize);
+  std::vector<PointF> chart;
+  for (uint32_t i = 0; i <= 64u; i++) {
+    const auto value = std::abs(std::sin(i * 0.2f));
+    chart.push_back({100.0f + i * 25.0f, 900.0f - 300.0f * value});
+  }
+  chart.push_back({1700.0f, 1000.0f});
+  chart.push_back({100.0f, 1000.0f});
+  while (state.KeepRunning()) {
+    rasterizer.Clear();
+    rasterizer.FillRect(Rect{0, 0, 1920, 1080}, kColorWhite);
+    for (int32_t i = 0; i < 64; i++) {
+      rasterizer.FillRoundRect(
+          Rect{40 + (i % 8) * 230, 40 + (i / 8) * 70, 200, 50}, 12.0f,
+          kColorBlue.WithAlpha(static_cast<uint8_t>(128 + i)));
+    }
+    for (int32_t i = 0; i < 256; i++) {
+      rasterizer.FillCircle({30.0f + (i * 97 % 1860), 600.0f + (i * 31 % 440)},
+                            8.0f, kColorRed);
+    }
+    rasterizer.FillPolygon(chart, kColorGreen.WithAlpha(160));
+    rasterizer.Draw(canvas);
+  }
+}
+BENCHMARK(RasterizeShapes)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static constexpr uint32_t kPathSegmentCount = 1000u;
+
+// A chart overlay: a line of a thousand points closed along the bottom of a
+// 1080p canvas, filled with a gradient.
+static void RasterizeChartPath(benchmark::State& state) {
+  Texture canvas;
+  MERLE_ASSERT(canvas.Resize(k1080pSize));
+  canvas.Clear(kColorWhite);
+  Path path;
+  path.MoveTo({0.0f, 1080.0f});
+  for (uint32_t i = 0; i < kPathSegmentCount; i++) {
+    const auto x = i * 1920.0f / (kPathSegmentCount - 1u);
+    const auto y =
+        540.0f + 300.0f * std::sin(i * 0.05f) + 100.0f * std::sin(i * 0.37f);
+    path.LineTo({x, y});
+  }
+  path.LineTo({1920.0f, 1080.0f});
+  PathRasterizer rasterizer(k1080pSize);
+  while (state.KeepRunning()) {
+    rasterizer.Rasterize(path);
+    rasterizer.FillLinearGradient(canvas, {0.0f, 200.0f}, {0.0f, 1080.0f},
+                                  kColorBlue.WithAlpha(192), kColorBlue);
+  }
+}
+BENCHMARK(RasterizeChartPath)->Unit(benchmark::TimeUnit::kMillisecond);
+
+// A star of a thousand lines that crosses itself all over, filled even-odd.
+static void RasterizeStarPath(benchmark::State& state) {
+  Texture canvas;
+  MERLE_ASSERT(canvas.Resize(k1080pSize));
+  Path path;
+  for (uint32_t i = 0; i < kPathSegmentCount; i++) {
+    const auto angle = i * 2.0f * kPi * 333.0f / kPathSegmentCount;
+    const PointF point = {960.0f + 500.0f * std::cos(angle),
+                          540.0f + 500.0f * std::sin(angle)};
+    if (i == 0u) {
+      path.MoveTo(point);
+    } else {
+      path.LineTo(point);
+    }
+  }
+  PathRasterizer rasterizer(k1080pSize);
+  while (state.KeepRunning()) {
+    rasterizer.Rasterize(path, FillRule::kEvenOdd);
+    rasterizer.Fill(canvas, kColorRed);
+  }
+}
+BENCHMARK(RasterizeStarPath)->Unit(benchmark::TimeUnit::kMillisecond);
+
 static void Grayscale(benchmark::State& state) {
   Texture texture;
   MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
@@ -192,6 +643,83 @@ static void GaussianBlur(benchmark::State& state) {
 }
 BENCHMARK(GaussianBlur)->Unit(benchmark::TimeUnit::kMillisecond);
 
+static void GaussianBlurLinear(benchmark::State& state) {
+  Texture texture;
+  Texture blur;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(blur.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorWhite);
+  blur.Clear(kColorBlack);
+  while (state.KeepRunning()) {
+    blur.GaussianBlur(texture, 2, 4.0f, LightSpace::kLinear);
+  }
+}
+BENCHMARK(GaussianBlurLinear)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void GaussianBlurInPlace(benchmark::State& state) {
+  Texture texture;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorWhite);
+  while (state.KeepRunning()) {
+    texture.GaussianBlur(2, 4.0f);
+  }
+}
+BENCHMARK(GaussianBlurInPlace)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void GaussianBlurThumbnails(benchmark::State& state) {
+  std::vector<Texture> textures(kThumbnailCount);
+  std::vector<Texture> blurs(kThumbnailCount);
+  for (uint32_t i = 0; i < kThumbnailCount; i++) {
+    MERLE_ASSERT(textures[i].Resize(kThumbnailSize));
+    MERLE_ASSERT(blurs[i].Resize(kThumbnailSize));
+    textures[i].Clear(kColorWhite);
+    blurs[i].Clear(kColorBlack);
+  }
+  while (state.KeepRunning()) {
+    for (uint32_t i = 0; i < kThumbnailCount; i++) {
+      blurs[i].GaussianBlur(textures[i], 2, 4.0f);
+    }
+  }
+}
+BENCHMARK(GaussianBlurThumbnails)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void GaussianBlurThumbnailBatch(benchmark::State& state) {
+  TextureBatch batch;
+  TextureBatch blur;
+  MERLE_ASSERT(batch.Resize(kThumbnailSize, kThumbnailCount));
+  MERLE_ASSERT(blur.Resize(kThumbnailSize, kThumbnailCount));
+  batch.GetTexture().Clear(kColorWhite);
+  blur.GetTexture().Clear(kColorBlack);
+  while (state.KeepRunning()) {
+    blur.GaussianBlur(batch, 2, 4.0f);
+  }
+}
+BENCHMARK(GaussianBlurThumbnailBatch)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void ContrastThumbnails(benchmark::State& state) {
+  std::vector<Texture> textures(kThumbnailCount);
+  for (auto& texture : textures) {
+    MERLE_ASSERT(texture.Resize(kThumbnailSize));
+    texture.Clear(kColorBlue);
+  }
+  while (state.KeepRunning()) {
+    for (auto& texture : textures) {
+      texture.Contrast(0.5f);
+    }
+  }
+}
+BENCHMARK(ContrastThumbnails)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void ContrastThumbnailBatch(benchmark::State& state) {
+  TextureBatch batch;
+  MERLE_ASSERT(batch.Resize(kThumbnailSize, kThumbnailCount));
+  batch.GetTexture().Clear(kColorBlue);
+  while (state.KeepRunning()) {
+    batch.Contrast(0.5f);
+  }
+}
+BENCHMARK(ContrastThumbnailBatch)->Unit(benchmark::TimeUnit::kMillisecond);
+
 static void Sobel(benchmark::State& state) {
   Texture texture;
   Texture sobel;
@@ -205,6 +733,63 @@ static void Sobel(benchmark::State& state) {
 }
 BENCHMARK(Sobel)->Unit(benchmark::TimeUnit::kMillisecond);
 
+static void SobelMask(benchmark::State& state) {
+  Texture texture;
+  FormattedTexture mask(kPixelFormatA8);
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(mask.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorWhite);
+  MERLE_ASSERT(mask.CopyFromTexture(texture, Component::kAlpha));
+  while (state.KeepRunning()) {
+    mask.Sobel(texture, Component::kRed);
+  }
+}
+BENCHMARK(SobelMask)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void GaussianBlurHalfFloat(benchmark::State& state) {
+  Texture texture;
+  FormattedTexture src(kPixelFormatR16F);
+  FormattedTexture blur(kPixelFormatR16F);
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(src.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(blur.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorWhite);
+  MERLE_ASSERT(src.CopyFromTexture(texture));
+  MERLE_ASSERT(blur.CopyFromTexture(texture));
+  while (state.KeepRunning()) {
+    blur.GaussianBlur(src, 2, 4.0f);
+  }
+}
+BENCHMARK(GaussianBlurHalfFloat)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void AverageLogLuminanceHalfFloat(benchmark::State& state) {
+  Texture texture;
+  FormattedTexture hdr(kPixelFormatRGBA16F);
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(hdr.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorBlue);
+  MERLE_ASSERT(hdr.CopyFromTexture(texture));
+  while (state.KeepRunning()) {
+    hdr.AverageLogLuminance();
+  }
+}
+BENCHMARK(AverageLogLuminanceHalfFloat)
+    ->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void ToneMapACESHalfFloat(benchmark::State& state) {
+  Texture texture;
+  FormattedTexture hdr(kPixelFormatRGBA16F);
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(hdr.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorBlue);
+  MERLE_ASSERT(hdr.CopyFromTexture(texture));
+  hdr.Exposure(4.0f);
+  while (state.KeepRunning()) {
+    hdr.ToneMap(texture, ToneMapOperator::kACES, hdr.GetAutoExposure());
+  }
+}
+BENCHMARK(ToneMapACESHalfFloat)->Unit(benchmark::TimeUnit::kMillisecond);
+
 static void DuplicateChannel(benchmark::State& state) {
   Texture texture;
   MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
@@ -229,6 +814,20 @@ static void FadeTransition(benchmark::State& state) {
 }
 BENCHMARK(FadeTransition)->Unit(benchmark::TimeUnit::kMillisecond);
 
+static void FadeTransitionLinear(benchmark::State& state) {
+  Texture a, b, c;
+  MERLE_ASSERT(a.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(b.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(c.Resize(kBenchmarkCanvasSize));
+  a.Clear(kColorFuchsia);
+  b.Clear(kColorBlue);
+  c.Clear(kColorRed);
+  while (state.KeepRunning()) {
+    c.FadeTransition(a, b, 0.75, LightSpace::kLinear);
+  }
+}
+BENCHMARK(FadeTransitionLinear)->Unit(benchmark::TimeUnit::kMillisecond);
+
 static void SwipeTransitionHorizontal(benchmark::State& state) {
   Texture a, b, c;
   MERLE_ASSERT(a.Resize(kBenchmarkCanvasSize));
@@ -277,6 +876,35 @@ static void IsOpaque(benchmark::State& state) {
 }
 BENCHMARK(IsOpaque)->Unit(benchmark::TimeUnit::kMillisecond);
 
+// More pixels than fit in 32 bits. Needs over 16 GiB.
+static constexpr UPoint kGigapixelCanvasSize = {(1 << 16) + 1, 1 << 16};
+
+static void InvertGigapixel(benchmark::State& state) {
+  Texture texture;
+  if (!texture.Resize(kGigapixelCanvasSize)) {
+    state.SkipWithError("Could not allocate the texture.");
+    return;
+  }
+  texture.Clear(kColorWhite);
+  while (state.KeepRunning()) {
+    texture.Invert();
+  }
+}
+BENCHMARK(InvertGigapixel)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void AverageColorGigapixel(benchmark::State& state) {
+  Texture texture;
+  if (!texture.Resize(kGigapixelCanvasSize)) {
+    state.SkipWithError("Could not allocate the texture.");
+    return;
+  }
+  texture.Clear(kColorWhite);
+  while (state.KeepRunning()) {
+    MERLE_ASSERT(texture.AverageColor() == kColorWhite);
+  }
+}
+BENCHMARK(AverageColorGigapixel)->Unit(benchmark::TimeUnit::kMillisecond);
+
 static void PremultiplyAlpha(benchmark::State& state) {
   Texture texture;
   MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
@@ -287,6 +915,291 @@ static void PremultiplyAlpha(benchmark::State& state) {
 }
 BENCHMARK(PremultiplyAlpha)->Unit(benchmark::TimeUnit::kMillisecond);
 
+static void SharedTextureOpacity(benchmark::State& state) {
+  Texture texture;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorWhite);
+  SharedTexture original(std::move(texture));
+  while (state.KeepRunning()) {
+    // Only the alpha plane of the copy is materialized.
+    SharedTexture copy = original;
+    copy.GetMutable().Opacity(0.5f);
+  }
+}
+BENCHMARK(SharedTextureOpacity)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void GrayscalePacked(benchmark::State& state) {
+  PackedTexture texture;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  while (state.KeepRunning()) {
+    texture.Grayscale();
+  }
+}
+BENCHMARK(GrayscalePacked)->Unit(benchmark::TimeUnit::kMillisecond);
+
+// What a one-shot filter on an interleaved image costs without the packed
+// kernels.
+static void GrayscalePackedViaPlanar(benchmark::State& state) {
+  PackedTexture packed;
+  Texture texture;
+  MERLE_ASSERT(packed.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  while (state.KeepRunning()) {
+    packed.CopyToTexture(texture);
+    texture.Grayscale();
+    packed.CopyFromTexture(texture);
+  }
+}
+BENCHMARK(GrayscalePackedViaPlanar)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void InvertPacked(benchmark::State& state) {
+  PackedTexture texture;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  while (state.KeepRunning()) {
+    texture.Invert();
+  }
+}
+BENCHMARK(InvertPacked)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void SepiaPacked(benchmark::State& state) {
+  PackedTexture texture(PixelOrder::kBGRA);
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  while (state.KeepRunning()) {
+    texture.Sepia();
+  }
+}
+BENCHMARK(SepiaPacked)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void OpacityPacked(benchmark::State& state) {
+  PackedTexture texture;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  while (state.KeepRunning()) {
+    texture.Opacity(0.5f);
+  }
+}
+BENCHMARK(OpacityPacked)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void BoxBlurPacked(benchmark::State& state) {
+  PackedTexture texture;
+  PackedTexture blur;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(blur.Resize(kBenchmarkCanvasSize));
+  while (state.KeepRunning()) {
+    blur.BoxBlur(texture, 2);
+  }
+}
+BENCHMARK(BoxBlurPacked)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void GaussianBlurPacked(benchmark::State& state) {
+  PackedTexture texture;
+  PackedTexture blur;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(blur.Resize(kBenchmarkCanvasSize));
+  while (state.KeepRunning()) {
+    blur.GaussianBlur(texture, 2, 4.0f);
+  }
+}
+BENCHMARK(GaussianBlurPacked)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void BoxBlurTiled(benchmark::State& state) {
+  TiledTexture texture;
+  TiledTexture blur;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(blur.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorWhite);
+  blur.Clear(kColorBlack);
+  while (state.KeepRunning()) {
+    blur.BoxBlur(texture, 2);
+  }
+}
+BENCHMARK(BoxBlurTiled)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void GaussianBlurTiled(benchmark::State& state) {
+  TiledTexture texture;
+  TiledTexture blur;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(blur.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorWhite);
+  blur.Clear(kColorBlack);
+  while (state.KeepRunning()) {
+    blur.GaussianBlur(texture, 2, 4.0f);
+  }
+}
+BENCHMARK(GaussianBlurTiled)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void SobelTiled(benchmark::State& state) {
+  TiledTexture texture;
+  TiledTexture sobel;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(sobel.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorWhite);
+  sobel.Clear(kColorBlack);
+  while (state.KeepRunning()) {
+    sobel.Sobel(texture, Component::kRed, Component::kRed);
+  }
+}
+BENCHMARK(SobelTiled)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void SwipeTransitionVerticalTiled(benchmark::State& state) {
+  TiledTexture a, b, c;
+  MERLE_ASSERT(a.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(b.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(c.Resize(kBenchmarkCanvasSize));
+  a.Clear(kColorFuchsia);
+  b.Clear(kColorBlue);
+  c.Clear(kColorRed);
+  while (state.KeepRunning()) {
+    c.SwipeTransition(a, b, 0.75, Texture::Direction::kVertical);
+  }
+}
+BENCHMARK(SwipeTransitionVerticalTiled)
+    ->Unit(benchmark::TimeUnit::kMillisecond);
+
+// A mostly transparent canvas with a single occupied 1024x1024 region.
+static void PrepareSparseCanvas(TiledTexture& canvas) {
+  Texture patch;
+  MERLE_ASSERT(patch.Resize({1024, 1024}));
+  patch.Clear(kColorFuchsia);
+  MERLE_ASSERT(canvas.Resize(kBenchmarkCanvasSize));
+  canvas.Clear(kColorTransparentBlack);
+  MERLE_ASSERT(canvas.Replace(patch, {4096, 4096}));
+}
+
+static void AverageColorSparse(benchmark::State& state) {
+  TiledTexture texture(TiledTexture::Storage::kSparse);
+  PrepareSparseCanvas(texture);
+  while (state.KeepRunning()) {
+    texture.AverageColor();
+  }
+}
+BENCHMARK(AverageColorSparse)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void OpacitySparse(benchmark::State& state) {
+  TiledTexture texture(TiledTexture::Storage::kSparse);
+  PrepareSparseCanvas(texture);
+  while (state.KeepRunning()) {
+    texture.Opacity(0.5);
+  }
+}
+BENCHMARK(OpacitySparse)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void GaussianBlurSparse(benchmark::State& state) {
+  TiledTexture texture(TiledTexture::Storage::kSparse);
+  TiledTexture blur(TiledTexture::Storage::kSparse);
+  PrepareSparseCanvas(texture);
+  MERLE_ASSERT(blur.Resize(kBenchmarkCanvasSize));
+  blur.Clear(kColorTransparentBlack);
+  while (state.KeepRunning()) {
+    blur.GaussianBlur(texture, 2, 4.0f);
+  }
+}
+BENCHMARK(GaussianBlurSparse)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void GaussianBlurStreamed(benchmark::State& state) {
+  Texture image;
+  Texture result;
+  MERLE_ASSERT(image.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(result.Resize(kBenchmarkCanvasSize));
+  image.Clear(kColorWhite);
+  OpChain chain;
+  chain.AddNeighborhoodOp(2u, [](const Texture& src, Texture& dst) {
+    return dst.GaussianBlur(src, 2u, 4.0f);
+  });
+  // Stands in for reading and writing a file.
+  auto copy_rows = [](const Texture& from, uint32_t from_row, Texture& to,
+                      uint32_t to_row, uint32_t rows) {
+    for (auto comp : kComponents) {
+      ::memcpy(to.GetAllocationMutable(comp, {0u, to_row}),
+               from.GetAllocation(comp, {0u, from_row}),
+               from.GetSize().x * rows);
+    }
+    return true;
+  };
+  StreamingExecutor executor(kBenchmarkCanvasSize, 256u);
+  while (state.KeepRunning()) {
+    executor.Run(
+        chain,
+        [&](uint32_t y, Texture& rows) {
+          return copy_rows(image, y, rows, 0u, rows.GetSize().y);
+        },
+        [&](uint32_t y, const Texture& rows) {
+          return copy_rows(rows, 0u, result, y, rows.GetSize().y);
+        });
+  }
+}
+BENCHMARK(GaussianBlurStreamed)->Unit(benchmark::TimeUnit::kMillisecond);
+
+// Contrast, then GaussianBlur, then Saturation, then Sobel. The same chain the
+// streaming and band executor tests check against a whole-texture run.
+static OpChain CreateBenchmarkChain() {
+  OpChain chain;
+  chain.AddPointOp([](Texture& texture) { texture.Contrast(0.3f); })
+      .AddNeighborhoodOp(3u,
+                         [](const Texture& src, Texture& dst) {
+                           return dst.GaussianBlur(src, 3u, 2.0f);
+                         })
+      .AddPointOp([](Texture& texture) { texture.Saturation(0.5f); })
+      .AddNeighborhoodOp(1u, [](const Texture& src, Texture& dst) {
+        return dst.Sobel(src, Component::kGreen, Component::kBlue);
+      });
+  return chain;
+}
+
+// Both runs start from the same source and leave the result in another
+// texture, so each pays for one copy of the canvas.
+static void OpChainWhole(benchmark::State& state) {
+  Texture src;
+  Texture texture;
+  Texture scratch;
+  MERLE_ASSERT(src.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  src.Clear(kColorFuchsia);
+  const auto chain = CreateBenchmarkChain();
+  while (state.KeepRunning()) {
+    texture.Replace(src, {});
+    chain.Run(texture, scratch);
+  }
+}
+BENCHMARK(OpChainWhole)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void OpChainBanded(benchmark::State& state) {
+  Texture src;
+  Texture dst;
+  MERLE_ASSERT(src.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(dst.Resize(kBenchmarkCanvasSize));
+  src.Clear(kColorFuchsia);
+  const auto chain = CreateBenchmarkChain();
+  BandExecutor executor;
+  while (state.KeepRunning()) {
+    executor.Run(chain, src, dst);
+  }
+}
+BENCHMARK(OpChainBanded)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void LinearToTiled(benchmark::State& state) {
+  Texture texture;
+  TiledTexture tiled;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(tiled.Resize(kBenchmarkCanvasSize));
+  texture.Clear(kColorWhite);
+  while (state.KeepRunning()) {
+    tiled.CopyFromTexture(texture);
+  }
+}
+BENCHMARK(LinearToTiled)->Unit(benchmark::TimeUnit::kMillisecond);
+
+static void TiledToLinear(benchmark::State& state) {
+  Texture texture;
+  TiledTexture tiled;
+  MERLE_ASSERT(texture.Resize(kBenchmarkCanvasSize));
+  MERLE_ASSERT(tiled.Resize(kBenchmarkCanvasSize));
+  tiled.Clear(kColorWhite);
+  while (state.KeepRunning()) {
+    tiled.CopyToTexture(texture);
+  }
+}
+BENCHMARK(TiledToLinear)->Unit(benchmark::TimeUnit::kMillisecond);
+
 }  // namespace merle
 
 BENCHMARK_MAIN();
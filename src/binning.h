@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      Sort the indices of items into bins, say tiles or bands of a
+///             canvas, with a counting sort. An item may go into any number of
+///             bins. Within each bin the items stay in the order of their
+///             indices, so items drawn bin by bin land on top of each other
+///             the same as if they were drawn one at a time.
+///
+/// @param[in]  bin_count     The number of bins.
+/// @param[in]  item_count    The number of items.
+/// @param[in]  for_each_bin  Called with the index of an item and a callable to
+///                           call with the index of each bin the item goes
+///                           into. Called twice per item and must give the
+///                           same bins both times.
+/// @param      offsets       Where the items of each bin start in `bins`. Has
+///                           one more entry than there are bins, the total.
+/// @param      bins          The indices of the items of each bin, bin after
+///                           bin.
+///
+template <class ForEachBin>
+void BinInOrder(size_t bin_count,
+                size_t item_count,
+                const ForEachBin& for_each_bin,
+                std::vector<uint32_t>& offsets,
+                std::vector<uint32_t>& bins) {
+  offsets.assign(bin_count + 1u, 0u);
+  for (size_t i = 0; i < item_count; i++) {
+    for_each_bin(i, [&](size_t bin) { offsets[bin + 1u]++; });
+  }
+  for (size_t i = 1; i <= bin_count; i++) {
+    offsets[i] += offsets[i - 1u];
+  }
+  bins.resize(offsets[bin_count]);
+  for (size_t i = 0; i < item_count; i++) {
+    for_each_bin(i, [&](size_t bin) {
+      bins[offsets[bin]++] = static_cast<uint32_t>(i);
+    });
+  }
+  // Each offset is now where the next bin starts. Shift them back.
+  for (size_t i = bin_count; i > 0; i--) {
+    offsets[i] = offsets[i - 1u];
+  }
+  offsets[0] = 0u;
+}
+
+}  // namespace merle
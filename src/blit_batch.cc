@@ -0,0 +1,102 @@
+#include "blit_batch.h"
+
+#include <array>
+
+#include "binning.h"
+#include "texture_ispc.h"
+
+namespace merle {
+
+void BlitBatch::Add(const Rect& atlas_rect,
+                    Point point,
+                    UnitScalarF opacity,
+                    Texture::BlendMode mode) {
+  blits_.push_back({atlas_rect, point, opacity, mode});
+}
+
+void BlitBatch::Clear() {
+  blits_.clear();
+}
+
+bool BlitBatch::Draw(const Texture& atlas, Texture& canvas) {
+  if (&atlas == &canvas) {
+    return false;
+  }
+  const auto size = canvas.GetSize();
+  if (size.GetArea() == 0u || blits_.empty()) {
+    return true;
+  }
+  const auto atlas_bounds =
+      Rect{Size{static_cast<int32_t>(atlas.GetSize().x),
+                static_cast<int32_t>(atlas.GetSize().y)}};
+  const auto canvas_bounds = Rect{
+      Size{static_cast<int32_t>(size.x), static_cast<int32_t>(size.y)}};
+
+  std::vector<ispc::Blit> clipped;
+  clipped.reserve(blits_.size());
+  for (const auto& blit : blits_) {
+    const auto src_rect = blit.atlas_rect.Intersection(atlas_bounds);
+    if (!src_rect.has_value() || src_rect->size.GetArea() == 0) {
+      continue;
+    }
+    const auto point =
+        Point{blit.point.x + src_rect->origin.x - blit.atlas_rect.origin.x,
+              blit.point.y + src_rect->origin.y - blit.atlas_rect.origin.y};
+    const auto dst_rect =
+        Rect{point, src_rect->size}.Intersection(canvas_bounds);
+    if (!dst_rect.has_value() || dst_rect->size.GetArea() == 0) {
+      continue;
+    }
+    clipped.push_back({
+        src_rect->origin.x + dst_rect->origin.x - point.x,  // src_x
+        src_rect->origin.y + dst_rect->origin.y - point.y,  // src_y
+        dst_rect->origin.x,                                  // dst_x
+        dst_rect->origin.y,                                  // dst_y
+        dst_rect->size.x,                                    // width
+        dst_rect->size.y,                                    // height
+        blit.opacity,                                        // opacity
+        static_cast<ispc::BlendMode>(blit.mode),             // mode
+    });
+  }
+
+  const uint32_t tile_columns = (size.x + kTileSize - 1u) / kTileSize;
+  const uint32_t tile_rows = (size.y + kTileSize - 1u) / kTileSize;
+  const size_t tile_count = static_cast<size_t>(tile_columns) * tile_rows;
+  const auto for_each_tile = [&](size_t index, auto&& proc) {
+    const auto& blit = clipped[index];
+    const uint32_t left = blit.dst_x / kTileSize;
+    const uint32_t right = (blit.dst_x + blit.width - 1) / kTileSize;
+    const uint32_t top = blit.dst_y / kTileSize;
+    const uint32_t bottom = (blit.dst_y + blit.height - 1) / kTileSize;
+    for (uint32_t y = top; y <= bottom; y++) {
+      for (uint32_t x = left; x <= right; x++) {
+        proc(static_cast<size_t>(y) * tile_columns + x);
+      }
+    }
+  };
+  BinInOrder(tile_count, clipped.size(), for_each_tile, tile_offsets_,
+             tile_blits_);
+  if (!canvas.MakePlanesUnique(kComponents)) {
+    return false;
+  }
+
+  std::array<const uint8_t*, 4u> atlas_planes;
+  std::array<uint8_t*, 4u> dst_planes;
+  for (size_t i = 0; i < kComponents.size(); i++) {
+    atlas_planes[i] = atlas.GetAllocation(kComponents[i]);
+    dst_planes[i] = canvas.GetAllocationMutable(kComponents[i]);
+  }
+  ispc::BlitBatch(atlas_planes.data(),   // atlas_planes
+                  dst_planes.data(),     // dst_planes
+                  atlas.GetSize().x,     // atlas_stride
+                  size.x,                // dst_width
+                  size.y,                // dst_height
+                  clipped.data(),        // blits
+                  tile_offsets_.data(),  // tile_offsets
+                  tile_blits_.data(),    // tile_blits
+                  kTileSize              // tile_size
+  );
+  return true;
+}
+
+}  // namespace merle
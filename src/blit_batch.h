@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "geom.h"
+#include "macros.h"
+#include "texture.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      A batch of blits of regions of an atlas, say icons or
+///             watermarks, onto a canvas.
+///
+///             Drawing thousands of small sprites one call at a time is
+///             dominated by per-call overhead. Here, blits are clipped and
+///             binned into square tiles of the canvas. The tiles are then
+///             drawn in a single launch with a task per tile. No two tasks
+///             write to the same pixels and within a tile the blits are drawn
+///             in the order they were added.
+///
+class BlitBatch {
+ public:
+  // The width and height of the tiles of the canvas blits are binned into.
+  static constexpr uint32_t kTileSize = 128u;
+
+  BlitBatch() = default;
+
+  ~BlitBatch() = default;
+
+  BlitBatch(BlitBatch&& other) = default;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Add a blit to the end of the batch.
+  ///
+  /// @param[in]  atlas_rect  The region of the atlas to blit. The parts
+  ///                         outside the atlas are clipped.
+  /// @param[in]  point       Where the top left of the region goes on the
+  ///                         canvas. May be negative.
+  /// @param[in]  opacity     Scales the alpha of the region.
+  /// @param[in]  mode        How the region is blended onto the canvas. See
+  ///                         `Texture::Blend`.
+  ///
+  void Add(const Rect& atlas_rect,
+           Point point,
+           UnitScalarF opacity = 1.0f,
+           Texture::BlendMode mode = Texture::BlendMode::kNormal);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Remove every blit. The memory of the batch is kept around for
+  ///             the next frame.
+  ///
+  void Clear();
+
+  size_t GetBlitCount() const { return blits_.size(); }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Draw every blit of the batch onto the canvas.
+  ///
+  /// @param[in]  atlas   The atlas the regions are in.
+  /// @param      canvas  The canvas. Must be a different texture.
+  ///
+  /// @return     If the textures differ.
+  ///
+  bool Draw(const Texture& atlas, Texture& canvas);
+
+ private:
+  struct Entry {
+    Rect atlas_rect;
+    Point point;
+    UnitScalarF opacity;
+    Texture::BlendMode mode;
+  };
+
+  std::vector<Entry> blits_;
+  // Scratch space for `Draw`, kept between frames.
+  std::vector<uint32_t> tile_offsets_;
+  std::vector<uint32_t> tile_blits_;
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(BlitBatch);
+};
+
+}  // namespace merle
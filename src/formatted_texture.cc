@@ -0,0 +1,257 @@
+#include "formatted_texture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+
+#include "texture_ispc.h"
+
+namespace merle {
+
+static ispc::ElementType ToISPC(ElementType type) {
+  return static_cast<ispc::ElementType>(type);
+}
+
+FormattedTexture::~FormattedTexture() {
+  std::free(allocation_);
+}
+
+FormattedTexture::FormattedTexture(FormattedTexture&& other) {
+  std::swap(format_, other.format_);
+  std::swap(size_, other.size_);
+  std::swap(allocation_, other.allocation_);
+}
+
+bool FormattedTexture::Resize(UPoint size) {
+  if (size_ == size) {
+    return true;
+  }
+  auto allocation = reinterpret_cast<uint8_t*>(
+      std::malloc(size.GetArea() * GetBytesPerPixel()));
+  if (allocation == nullptr) {
+    return false;
+  }
+  std::free(allocation_);
+  allocation_ = allocation;
+  size_ = size;
+  return true;
+}
+
+bool FormattedTexture::CopyFromTexture(const Texture& texture,
+                                       Component first) {
+  const auto first_index = static_cast<uint8_t>(first);
+  if (texture.GetSize() != size_ ||
+      first_index + format_.channel_count > 4u) {
+    return false;
+  }
+  for (uint8_t i = 0; i < format_.channel_count; i++) {
+    const auto comp = static_cast<Component>(first_index + i);
+    ispc::ConvertPlane(texture.GetAllocation(comp),   // src
+                       ispc::kU8,                     // src type
+                       GetPlaneMutable(i),            // dst
+                       ToISPC(format_.element_type),  // dst type
+                       GetPixelCount()                // size
+    );
+  }
+  return true;
+}
+
+bool FormattedTexture::CopyToTexture(Texture& texture, Component first) const {
+  const auto first_index = static_cast<uint8_t>(first);
+  if (texture.GetSize() != size_ ||
+      first_index + format_.channel_count > 4u) {
+    return false;
+  }
+  const auto comps =
+      std::span(kComponents).subspan(first_index, format_.channel_count);
+  if (!texture.MakePlanesUnique(comps, /*preserve_contents=*/false)) {
+    return false;
+  }
+  for (uint8_t i = 0; i < format_.channel_count; i++) {
+    const auto comp = comps[i];
+    ispc::ConvertPlane(GetPlane(i),                         // src
+                       ToISPC(format_.element_type),        // src type
+                       texture.GetAllocationMutable(comp),  // dst
+                       ispc::kU8,                           // dst type
+                       GetPixelCount()                      // size
+    );
+  }
+  return true;
+}
+
+// The color components of textures are sRGB-encoded. Alpha is linear.
+static ispc::ElementType GetTextureElementType(uint8_t channel) {
+  return channel < 3u ? ispc::kSRGB8 : ispc::kU8;
+}
+
+bool FormattedTexture::DecodeFromTexture(const Texture& texture) {
+  if (texture.GetSize() != size_ || format_.channel_count > 4u) {
+    return false;
+  }
+  for (uint8_t i = 0; i < format_.channel_count; i++) {
+    const auto comp = static_cast<Component>(i);
+    ispc::ConvertPlane(texture.GetAllocation(comp),   // src
+                       GetTextureElementType(i),      // src type
+                       GetPlaneMutable(i),            // dst
+                       ToISPC(format_.element_type),  // dst type
+                       GetPixelCount()                // size
+    );
+  }
+  return true;
+}
+
+bool FormattedTexture::EncodeToTexture(Texture& texture) const {
+  if (texture.GetSize() != size_ || format_.channel_count > 4u ||
+      !texture.MakePlanesUnique(
+          std::span(kComponents).first(format_.channel_count),
+          /*preserve_contents=*/false)) {
+    return false;
+  }
+  for (uint8_t i = 0; i < format_.channel_count; i++) {
+    const auto comp = static_cast<Component>(i);
+    ispc::ConvertPlane(GetPlane(i),                         // src
+                       ToISPC(format_.element_type),        // src type
+                       texture.GetAllocationMutable(comp),  // dst
+                       GetTextureElementType(i),            // dst type
+                       GetPixelCount()                      // size
+    );
+  }
+  return true;
+}
+
+bool FormattedTexture::Convert(const FormattedTexture& src) {
+  if (src.size_ != size_ ||
+      src.format_.channel_count != format_.channel_count) {
+    return false;
+  }
+  for (uint8_t i = 0; i < format_.channel_count; i++) {
+    if (src.format_.element_type == format_.element_type) {
+      ::memcpy(GetPlaneMutable(i), src.GetPlane(i),
+               GetPixelCount() * format_.GetBytesPerElement());
+      continue;
+    }
+    ispc::ConvertPlane(src.GetPlane(i),                   // src
+                       ToISPC(src.format_.element_type),  // src type
+                       GetPlaneMutable(i),                // dst
+                       ToISPC(format_.element_type),      // dst type
+                       GetPixelCount()                    // size
+    );
+  }
+  return true;
+}
+
+bool FormattedTexture::BoxBlur(const FormattedTexture& src, uint8_t radius) {
+  return ConvolutionNxN(src, Texture::CreateBoxKernel(radius));
+}
+
+bool FormattedTexture::GaussianBlur(const FormattedTexture& src,
+                                    uint8_t radius,
+                                    float sigma) {
+  return ConvolutionNxN(src, Texture::CreateGaussianKernel(radius, sigma));
+}
+
+bool FormattedTexture::ConvolutionNxN(const FormattedTexture& src,
+                                      const std::vector<float>& kernel) {
+  if (src.size_ != size_ || src.format_ != format_) {
+    return false;
+  }
+  for (uint8_t i = 0; i < format_.channel_count; i++) {
+    ispc::ConvolutionNxNPlane(src.GetPlane(i),                    // src
+                              GetPlaneMutable(i),                 // dst
+                              ToISPC(format_.element_type),       // type
+                              size_.x,                            // width
+                              size_.y,                            // height
+                              const_cast<float*>(kernel.data()),  // kernel
+                              kernel.size()                       // kernel size
+    );
+  }
+  return true;
+}
+
+void FormattedTexture::Exposure(float exposure) {
+  const auto factor = std::exp2(exposure);
+  for (uint8_t i = 0; i < std::min<uint8_t>(format_.channel_count, 3u); i++) {
+    ispc::ScalePlane(GetPlaneMutable(i),            // plane
+                     ToISPC(format_.element_type),  // type
+                     factor,                        // factor
+                     GetPixelCount()                // size
+    );
+  }
+}
+
+bool FormattedTexture::ColorMatrix(const Matrix& matrix) {
+  if (format_.channel_count != 4u) {
+    return false;
+  }
+  ispc::ColorMatrixFormatted(GetPlaneMutable(0u),           // r
+                             GetPlaneMutable(1u),           // g
+                             GetPlaneMutable(2u),           // b
+                             GetPlaneMutable(3u),           // a
+                             ToISPC(format_.element_type),  // type
+                             GetPixelCount(),               // size
+                             reinterpret_cast<const ispc::Matrix&>(matrix.e));
+  return true;
+}
+
+float FormattedTexture::AverageLogLuminance() const {
+  if (format_.channel_count < 3u) {
+    return 0.0f;
+  }
+  return ispc::AverageLogLuminance(GetPlane(0u),                  // r
+                                   GetPlane(1u),                  // g
+                                   GetPlane(2u),                  // b
+                                   ToISPC(format_.element_type),  // type
+                                   GetPixelCount()                // size
+  );
+}
+
+float FormattedTexture::GetAutoExposure(float key) const {
+  const auto average = AverageLogLuminance();
+  if (average <= 0.0f) {
+    return 0.0f;
+  }
+  return std::log2(key / average);
+}
+
+bool FormattedTexture::ToneMap(Texture& dst,
+                               ToneMapOperator op,
+                               float exposure) const {
+  if (dst.GetSize() != size_ || format_.channel_count < 3u ||
+      !dst.MakePlanesUnique(kComponents, /*preserve_contents=*/false)) {
+    return false;
+  }
+  const auto alpha = format_.channel_count > 3u ? GetPlane(3u) : nullptr;
+  ispc::ToneMap(GetPlane(0u),                            // r
+                GetPlane(1u),                            // g
+                GetPlane(2u),                            // b
+                alpha,                                   // a
+                ToISPC(format_.element_type),            // type
+                dst.GetRedMutable(),                     // dst r
+                dst.GetGreenMutable(),                   // dst g
+                dst.GetBlueMutable(),                    // dst b
+                dst.GetAlphaMutable(),                   // dst a
+                static_cast<ispc::ToneMapOperator>(op),  // op
+                exposure,                                // exposure
+                GetPixelCount()                          // size
+  );
+  return true;
+}
+
+bool FormattedTexture::Sobel(const Texture& src,
+                             Component src_component,
+                             uint8_t dst_channel) {
+  if (src.GetSize() != size_ || format_.element_type != ElementType::kU8 ||
+      dst_channel >= format_.channel_count) {
+    return false;
+  }
+  ispc::Sobel(src.GetAllocation(src_component),       // src
+              GetPlaneMutable<uint8_t>(dst_channel),  // dst
+              size_.x,                                // width
+              size_.y                                 // height
+  );
+  return true;
+}
+
+}  // namespace merle
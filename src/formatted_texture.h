@@ -0,0 +1,183 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "geom.h"
+#include "macros.h"
+#include "pixel_format.h"
+#include "texture.h"
+
+namespace merle {
+
+enum class ToneMapOperator : uint8_t {
+  // Clip components to [0, 1].
+  kClamp,
+  // x / (1 + x) of each component.
+  kReinhard,
+  // A fit of the ACES filmic curve.
+  kACES,
+};
+
+//------------------------------------------------------------------------------
+/// @brief      A planar texture whose channel count and element type are given
+///             by its pixel format.
+///
+///             A `Texture` always has four 8-bit planes. Masks and the output
+///             of `Sobel` only need one, and high dynamic range images are
+///             clipped and quantized between every filter. Single channel
+///             formats use a quarter of the memory and float formats keep
+///             intermediate results unclipped.
+///
+///             Kernels convert elements to and from floats a few at a time, so
+///             the same kernel works for every element type.
+///
+class FormattedTexture {
+ public:
+  explicit FormattedTexture(PixelFormat format = kPixelFormatRGBA8)
+      : format_(format) {}
+
+  ~FormattedTexture();
+
+  FormattedTexture(FormattedTexture&& other);
+
+  bool Resize(UPoint size);
+
+  const UPoint& GetSize() const { return size_; }
+
+  const PixelFormat& GetFormat() const { return format_; }
+
+  size_t GetBytesPerPixel() const { return format_.GetBytesPerPixel(); }
+
+  size_t GetPixelCount() const { return size_.GetArea(); }
+
+  const void* GetPlane(uint8_t channel) const {
+    return allocation_ +
+           GetPixelCount() * format_.GetBytesPerElement() * channel;
+  }
+
+  void* GetPlaneMutable(uint8_t channel) {
+    return const_cast<void*>(GetPlane(channel));
+  }
+
+  template <class T>
+  const T* GetPlane(uint8_t channel) const {
+    return static_cast<const T*>(GetPlane(channel));
+  }
+
+  template <class T>
+  T* GetPlaneMutable(uint8_t channel) {
+    return static_cast<T*>(GetPlaneMutable(channel));
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Copy consecutive components of a texture of the same size
+  ///             into the channels of this one.
+  ///
+  /// @param[in]  texture  The texture to copy from.
+  /// @param[in]  first    The component copied into the first channel.
+  ///
+  /// @return     If the sizes match and there is a component for every
+  ///             channel.
+  ///
+  bool CopyFromTexture(const Texture& texture,
+                       Component first = Component::kRed);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Copy the channels of this texture into consecutive components
+  ///             of a texture of the same size. To expand a single channel
+  ///             into several components without more copies, follow this
+  ///             with `Texture::DuplicateChannel`.
+  ///
+  bool CopyToTexture(Texture& texture, Component first = Component::kRed) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `CopyFromTexture` but the sRGB-encoded color
+  ///             components are decoded to linear light. A fourth channel is
+  ///             copied from alpha as is. With 16-bit or float elements, this
+  ///             keeps the precision of dark colors 8-bit linear values lose.
+  ///
+  bool DecodeFromTexture(const Texture& texture);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `CopyToTexture` but the first three channels are
+  ///             encoded from linear light to sRGB.
+  ///
+  bool EncodeToTexture(Texture& texture) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Convert a texture with the same size and channel count but
+  ///             any element type into this one.
+  ///
+  bool Convert(const FormattedTexture& src);
+
+  bool BoxBlur(const FormattedTexture& src, uint8_t radius = 1u);
+
+  bool GaussianBlur(const FormattedTexture& src, uint8_t radius, float sigma);
+
+  bool ConvolutionNxN(const FormattedTexture& src,
+                      const std::vector<float>& kernel);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Scale the first three channels by `2^exposure`. Unlike
+  ///             `Texture::Exposure`, float elements are not clipped.
+  ///
+  void Exposure(float exposure);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `Texture::ColorMatrix` but float elements are not
+  ///             clipped.
+  ///
+  /// @return     If the texture has four channels.
+  ///
+  bool ColorMatrix(const Matrix& matrix);
+
+  //----------------------------------------------------------------------------
+  /// @brief      The geometric mean of the luminance of the pixels. This is
+  ///             the "key" of a high dynamic range image. Zero for textures
+  ///             with less than three channels.
+  ///
+  float AverageLogLuminance() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      The exposure in stops that maps the average log luminance to
+  ///             the given key.
+  ///
+  /// @param[in]  key   The luminance the average should be mapped to. 0.18f
+  ///                   is middle gray.
+  ///
+  float GetAutoExposure(float key = 0.18f) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Expose, tone map and quantize the first three channels into
+  ///             the color components of a texture of the same size in one
+  ///             pass. The fourth channel, if any, is quantized into alpha.
+  ///             Otherwise, the texture is made opaque.
+  ///
+  /// @param      dst       The texture to write to.
+  /// @param[in]  op        The tone mapping operator.
+  /// @param[in]  exposure  The exposure in stops applied before tone mapping.
+  ///
+  /// @return     If the sizes match and this texture has at least three
+  ///             channels.
+  ///
+  bool ToneMap(Texture& dst, ToneMapOperator op, float exposure = 0.0f) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `Texture::Sobel` but written to a channel of this
+  ///             texture, which must have 8-bit elements. An A8 texture makes
+  ///             for an edge mask a quarter of the size of a `Texture`.
+  ///
+  bool Sobel(const Texture& src,
+             Component src_component,
+             uint8_t dst_channel = 0u);
+
+ private:
+  PixelFormat format_;
+  UPoint size_ = {};
+  uint8_t* allocation_ = nullptr;
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(FormattedTexture);
+};
+
+}  // namespace merle
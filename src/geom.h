@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <optional>
+#include <type_traits>
 
 namespace merle {
 
@@ -59,6 +60,11 @@ struct Matrix {
 template <class T>
 struct TPoint {
   using Type = T;
+  // Wide enough to hold the product of any two components.
+  using AreaType = std::conditional_t<
+      std::is_integral_v<T>,
+      std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>,
+      T>;
 
   Type x = {};
   Type y = {};
@@ -73,7 +79,9 @@ struct TPoint {
 
   constexpr bool IsEmpty() const { return x < Type{} || y < Type{}; }
 
-  constexpr Type GetArea() const { return x * y; }
+  constexpr AreaType GetArea() const {
+    return static_cast<AreaType>(x) * static_cast<AreaType>(y);
+  }
 };
 
 template <class T>
@@ -145,6 +153,8 @@ using Point = TPoint<int32_t>;
 using Size = TSize<int32_t>;
 using Rect = TRect<int32_t>;
 
+using PointF = TPoint<ScalarF>;
+
 struct Radians {
   ScalarF radians = 0.0;
 
@@ -166,6 +176,163 @@ struct Degrees {
   };
 };
 
+//------------------------------------------------------------------------------
+/// @brief      A projective transform of 2D points. Points are mapped as the
+///             column vector (x, y, 1) and divided by the resulting third
+///             component. Affine transforms have a bottom row of (0, 0, 1).
+///
+struct Transform {
+  union {
+    ScalarF m[9];
+    ScalarF e[3][3];
+  };
+
+  constexpr Transform()
+      : e{
+            // clang-format off
+    {1.0f, 0.0f, 0.0f},
+    {0.0f, 1.0f, 0.0f},
+    {0.0f, 0.0f, 1.0f},
+            // clang-format on
+        } {}
+
+  constexpr Transform(
+      // clang-format off
+    ScalarF m00, ScalarF m01, ScalarF m02, //
+    ScalarF m10, ScalarF m11, ScalarF m12, //
+    ScalarF m20, ScalarF m21, ScalarF m22  //
+                   // clang-format on
+      )
+      : e{
+            // clang-format off
+    {m00, m01, m02}, //
+    {m10, m11, m12}, //
+    {m20, m21, m22}  //
+                 // clang-format on
+        } {}
+
+  static constexpr Transform MakeTranslation(ScalarF x, ScalarF y) {
+    return Transform(1.0f, 0.0f, x, 0.0f, 1.0f, y, 0.0f, 0.0f, 1.0f);
+  }
+
+  static constexpr Transform MakeScale(ScalarF x, ScalarF y) {
+    return Transform(x, 0.0f, 0.0f, 0.0f, y, 0.0f, 0.0f, 0.0f, 1.0f);
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      A rotation about the origin. With y pointing down, positive
+  ///             angles turn clockwise.
+  ///
+  static Transform MakeRotation(Radians angle) {
+    const auto cos = std::cos(angle.radians);
+    const auto sin = std::sin(angle.radians);
+    return Transform(cos, -sin, 0.0f, sin, cos, 0.0f, 0.0f, 0.0f, 1.0f);
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      A shear that moves x by `x` times y and y by `y` times x.
+  ///
+  static constexpr Transform MakeSkew(ScalarF x, ScalarF y) {
+    return Transform(1.0f, x, 0.0f, y, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      The transform that maps the corners of one quadrilateral
+  ///             onto those of another, in order. For deskewing, map the
+  ///             corners of a skewed document onto a rectangle.
+  ///
+  /// @return     The transform or nothing if either quadrilateral has three
+  ///             corners on a line.
+  ///
+  static constexpr std::optional<Transform> MakeQuadToQuad(
+      const std::array<PointF, 4>& from,
+      const std::array<PointF, 4>& to) {
+    const auto from_square = MakeSquareToQuad(from);
+    const auto to_square = MakeSquareToQuad(to);
+    if (!from_square.has_value() || !to_square.has_value()) {
+      return std::nullopt;
+    }
+    const auto inverse = from_square->Invert();
+    if (!inverse.has_value()) {
+      return std::nullopt;
+    }
+    return *to_square * *inverse;
+  }
+
+  constexpr bool IsAffine() const {
+    return e[2][0] == 0.0f && e[2][1] == 0.0f && e[2][2] == 1.0f;
+  }
+
+  constexpr ScalarF GetDeterminant() const {
+    return e[0][0] * (e[1][1] * e[2][2] - e[1][2] * e[2][1]) -
+           e[0][1] * (e[1][0] * e[2][2] - e[1][2] * e[2][0]) +
+           e[0][2] * (e[1][0] * e[2][1] - e[1][1] * e[2][0]);
+  }
+
+  constexpr std::optional<Transform> Invert() const {
+    const auto det = GetDeterminant();
+    if (det == 0.0f) {
+      return std::nullopt;
+    }
+    const auto inv = 1.0f / det;
+    return Transform((e[1][1] * e[2][2] - e[1][2] * e[2][1]) * inv,
+                     (e[0][2] * e[2][1] - e[0][1] * e[2][2]) * inv,
+                     (e[0][1] * e[1][2] - e[0][2] * e[1][1]) * inv,
+                     (e[1][2] * e[2][0] - e[1][0] * e[2][2]) * inv,
+                     (e[0][0] * e[2][2] - e[0][2] * e[2][0]) * inv,
+                     (e[0][2] * e[1][0] - e[0][0] * e[1][2]) * inv,
+                     (e[1][0] * e[2][1] - e[1][1] * e[2][0]) * inv,
+                     (e[0][1] * e[2][0] - e[0][0] * e[2][1]) * inv,
+                     (e[0][0] * e[1][1] - e[0][1] * e[1][0]) * inv);
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      The transform that applies `other` and then this one.
+  ///
+  constexpr Transform operator*(const Transform& other) const {
+    Transform result;
+    for (size_t row = 0; row < 3; row++) {
+      for (size_t col = 0; col < 3; col++) {
+        result.e[row][col] = e[row][0] * other.e[0][col] +
+                             e[row][1] * other.e[1][col] +
+                             e[row][2] * other.e[2][col];
+      }
+    }
+    return result;
+  }
+
+  constexpr PointF Map(PointF point) const {
+    const auto x = e[0][0] * point.x + e[0][1] * point.y + e[0][2];
+    const auto y = e[1][0] * point.x + e[1][1] * point.y + e[1][2];
+    const auto w = e[2][0] * point.x + e[2][1] * point.y + e[2][2];
+    return {x / w, y / w};
+  }
+
+ private:
+  // Maps the corners of the unit square, clockwise from the origin, onto the
+  // quad. From Heckbert's "Fundamentals of Texture Mapping and Image
+  // Warping".
+  static constexpr std::optional<Transform> MakeSquareToQuad(
+      const std::array<PointF, 4>& quad) {
+    const auto& [p0, p1, p2, p3] = quad;
+    const auto sx = p0.x - p1.x + p2.x - p3.x;
+    const auto sy = p0.y - p1.y + p2.y - p3.y;
+    const auto dx1 = p1.x - p2.x;
+    const auto dx2 = p3.x - p2.x;
+    const auto dy1 = p1.y - p2.y;
+    const auto dy2 = p3.y - p2.y;
+    const auto det = dx1 * dy2 - dx2 * dy1;
+    if (det == 0.0f) {
+      return std::nullopt;
+    }
+    const auto g = (sx * dy2 - dx2 * sy) / det;
+    const auto h = (dx1 * sy - sx * dy1) / det;
+    return Transform(p1.x - p0.x + g * p1.x, p3.x - p0.x + h * p3.x, p0.x,
+                     p1.y - p0.y + g * p1.y, p3.y - p0.y + h * p3.y, p0.y,
+                     g, h, 1.0f);
+  }
+};
+
 struct Color {
   union {
     uint32_t color = {};
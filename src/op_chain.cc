@@ -0,0 +1,40 @@
+#include "op_chain.h"
+
+namespace merle {
+
+OpChain& OpChain::AddPointOp(PointProc proc) {
+  ops_.push_back(Op{.point_proc = std::move(proc)});
+  return *this;
+}
+
+OpChain& OpChain::AddNeighborhoodOp(uint32_t radius, NeighborhoodProc proc) {
+  ops_.push_back(Op{.radius = radius, .neighborhood_proc = std::move(proc)});
+  halo_ += radius;
+  return *this;
+}
+
+bool OpChain::Run(Texture& texture) const {
+  Texture scratch;
+  return Run(texture, scratch);
+}
+
+bool OpChain::Run(Texture& texture, Texture& scratch) const {
+  for (const auto& op : ops_) {
+    if (op.point_proc) {
+      op.point_proc(texture);
+      continue;
+    }
+    if (!scratch.Resize(texture.GetSize()) ||
+        !scratch.MakePlanesUnique(kComponents)) {
+      return false;
+    }
+    scratch.Replace(texture, {});
+    if (!op.neighborhood_proc(texture, scratch)) {
+      return false;
+    }
+    std::swap(texture, scratch);
+  }
+  return true;
+}
+
+}  // namespace merle
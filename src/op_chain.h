@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+#include "macros.h"
+#include "texture.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      A sequence of texture operations. The chain may be run on a
+///             whole texture or, by an executor, on horizontal strips of one.
+///
+///             Point ops only read the pixel they write. Neighborhood ops read
+///             pixels up to a number of rows away and write to a destination
+///             that starts out as a copy of their source. Pixels they don't
+///             write to (say, along the edges of a convolution) keep their
+///             values.
+///
+class OpChain {
+ public:
+  using PointProc = std::function<void(Texture& texture)>;
+
+  using NeighborhoodProc =
+      std::function<bool(const Texture& src, Texture& dst)>;
+
+  OpChain() = default;
+
+  ~OpChain() = default;
+
+  OpChain(OpChain&& other) = default;
+
+  OpChain& AddPointOp(PointProc proc);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Add an op whose output pixels depend on source pixels up to
+  ///             `radius` rows above and below them.
+  ///
+  OpChain& AddNeighborhoodOp(uint32_t radius, NeighborhoodProc proc);
+
+  //----------------------------------------------------------------------------
+  /// @brief      The number of rows above and below a strip that must be run
+  ///             through the chain along with it for the rows of the strip to
+  ///             come out the same as if the whole texture were.
+  ///
+  uint32_t GetHalo() const { return halo_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Run every op of the chain on the texture.
+  ///
+  /// @return     If all neighborhood ops succeeded.
+  ///
+  bool Run(Texture& texture) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Run every op of the chain on the texture. Neighborhood ops
+  ///             write to the scratch texture, which is then swapped with the
+  ///             texture. Reusing the scratch texture across runs on textures
+  ///             of the same size avoids allocating on each run.
+  ///
+  bool Run(Texture& texture, Texture& scratch) const;
+
+ private:
+  struct Op {
+    uint32_t radius = 0u;
+    PointProc point_proc;
+    NeighborhoodProc neighborhood_proc;
+  };
+  std::vector<Op> ops_;
+  uint32_t halo_ = 0u;
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(OpChain);
+};
+
+}  // namespace merle
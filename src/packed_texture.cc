@@ -0,0 +1,151 @@
+#include "packed_texture.h"
+
+#include <stb_image.h>
+
+#include <cstdlib>
+
+#include "texture_ispc.h"
+
+namespace merle {
+
+std::optional<PackedTexture> PackedTexture::CreateFromFile(const char* name) {
+  int x = 0;
+  int y = 0;
+  int channels = 0;
+
+  stbi_uc* decoded = ::stbi_load(name, &x, &y, &channels, STBI_rgb_alpha);
+
+  if (decoded == nullptr || x < 0 || y < 0) {
+    std::cout << "Could not load image: " << name << std::endl;
+    return std::nullopt;
+  }
+
+  // The decoder already produces interleaved RGBA. Adopt it as is.
+  return PackedTexture(
+      decoded, {static_cast<uint32_t>(x), static_cast<uint32_t>(y)},
+      PixelOrder::kRGBA,
+      [](uint8_t* allocation) { ::stbi_image_free(allocation); });
+}
+
+void PackedTexture::ReleaseAllocation() {
+  if (release_proc_) {
+    release_proc_(allocation_);
+  } else {
+    std::free(allocation_);
+  }
+  allocation_ = nullptr;
+  size_ = {};
+  release_proc_ = nullptr;
+}
+
+bool PackedTexture::Resize(UPoint size) {
+  if (size_ == size) {
+    return true;
+  }
+  const auto new_allocation_size = size.GetArea() * GetBytesPerPixel();
+  if (release_proc_) {
+    ReleaseAllocation();
+  }
+  auto new_allocation = std::realloc(allocation_, new_allocation_size);
+  if (new_allocation == nullptr) {
+    return false;
+  }
+  allocation_ = reinterpret_cast<uint8_t*>(new_allocation);
+  size_ = size;
+  return true;
+}
+
+bool PackedTexture::CopyFromTexture(const Texture& texture) {
+  if (texture.GetSize() != GetSize()) {
+    return false;
+  }
+  ispc::CopyToPacked(texture.GetRed(),    // red
+                     texture.GetGreen(),  // green
+                     texture.GetBlue(),   // blue
+                     texture.GetAlpha(),  // alpha
+                     reinterpret_cast<uint32_t*>(allocation_),  // packed(out)
+                     static_cast<ispc::PixelOrder>(order_),     // order
+                     GetPixelCount()                            // length
+  );
+  return true;
+}
+
+bool PackedTexture::CopyToTexture(Texture& texture) const {
+  if (texture.GetSize() != GetSize() ||
+      !texture.MakePlanesUnique(kComponents, /*preserve_contents=*/false)) {
+    return false;
+  }
+  ispc::FromPacked(reinterpret_cast<const uint32_t*>(allocation_),  // packed
+                   static_cast<ispc::PixelOrder>(order_),           // order
+                   texture.GetRedMutable(),                         // red
+                   texture.GetGreenMutable(),                       // green
+                   texture.GetBlueMutable(),                        // blue
+                   texture.GetAlphaMutable(),                       // alpha
+                   GetPixelCount()                                  // length
+  );
+  return true;
+}
+
+void PackedTexture::Grayscale() {
+  ispc::GrayscalePacked(reinterpret_cast<uint32_t*>(allocation_),  // pixels
+                        static_cast<ispc::PixelOrder>(order_),     // order
+                        GetPixelCount()                            // length
+  );
+}
+
+void PackedTexture::Invert() {
+  ispc::InvertPacked(reinterpret_cast<uint32_t*>(allocation_),  // pixels
+                     GetPixelCount()                            // length
+  );
+}
+
+void PackedTexture::ColorMatrix(const Matrix& matrix) {
+  ispc::ColorMatrixPacked(reinterpret_cast<uint32_t*>(allocation_),  // pixels
+                          static_cast<ispc::PixelOrder>(order_),     // order
+                          GetPixelCount(),                           // length
+                          reinterpret_cast<const ispc::Matrix&>(matrix.e));
+}
+
+void PackedTexture::Sepia() {
+  ColorMatrix(Matrix{
+      0.3588, 0.7044, 0.1368, 0.0,  //
+      0.2990, 0.5870, 0.1140, 0.0,  //
+      0.2392, 0.4696, 0.0912, 0.0,  //
+      0, 0, 0, 1.0,                 //
+  });
+}
+
+void PackedTexture::Opacity(UnitScalarF opacity) {
+  ispc::OpacityPacked(reinterpret_cast<uint32_t*>(allocation_),  // pixels
+                      GetPixelCount(),                           // length
+                      opacity                                    // opacity
+  );
+}
+
+bool PackedTexture::BoxBlur(const PackedTexture& src, uint8_t radius) {
+  return ConvolutionNxN(src, Texture::CreateBoxKernel(radius));
+}
+
+bool PackedTexture::GaussianBlur(const PackedTexture& src,
+                                 uint8_t radius,
+                                 float sigma) {
+  return ConvolutionNxN(src, Texture::CreateGaussianKernel(radius, sigma));
+}
+
+bool PackedTexture::ConvolutionNxN(const PackedTexture& src,
+                                   const std::vector<float>& kernel) {
+  if (size_ != src.size_ || order_ != src.order_) {
+    return false;
+  }
+  ispc::ConvolutionNxNPacked(
+      reinterpret_cast<const uint32_t*>(src.allocation_),  // src
+      reinterpret_cast<uint32_t*>(allocation_),            // dst
+      size_.x,                                             // width
+      size_.y,                                             // height
+      const_cast<float*>(kernel.data()),                   // kernel
+      kernel.size()                                        // kernel size
+  );
+  return true;
+}
+
+}  // namespace merle
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "geom.h"
+#include "macros.h"
+#include "texture.h"
+
+namespace merle {
+
+enum class PixelOrder : uint8_t {
+  kRGBA,
+  kBGRA,
+};
+
+//------------------------------------------------------------------------------
+/// @brief      A texture whose components are interleaved in a single plane.
+///             The filters here deinterleave pixels in registers and write
+///             them back interleaved. For one-shot filters on decoded or
+///             captured images, this avoids having to gather into a planar
+///             `Texture` and scatter the results back out.
+///
+class PackedTexture {
+ public:
+  static std::optional<PackedTexture> CreateFromFile(const char* name);
+
+  using ReleaseProc = Texture::ReleaseProc;
+
+  PackedTexture(PixelOrder order = PixelOrder::kRGBA) : order_(order) {}
+
+  //----------------------------------------------------------------------------
+  /// @brief      Wrap an interleaved allocation owned by the caller without
+  ///             copying it.
+  ///
+  /// @param[in]  allocation    The allocation to wrap.
+  /// @param[in]  size          The size of the texture.
+  /// @param[in]  order         The order of the components in each pixel.
+  /// @param[in]  release_proc  Called with the allocation once the texture no
+  ///                           longer references it.
+  ///
+  PackedTexture(uint8_t* allocation,
+                UPoint size,
+                PixelOrder order,
+                ReleaseProc release_proc)
+      : allocation_(allocation),
+        size_(size),
+        order_(order),
+        release_proc_(std::move(release_proc)) {}
+
+  static PackedTexture Borrow(uint8_t* allocation,
+                              UPoint size,
+                              PixelOrder order) {
+    return PackedTexture(allocation, size, order, [](uint8_t*) {});
+  }
+
+  ~PackedTexture() { ReleaseAllocation(); }
+
+  PackedTexture(PackedTexture&& other) {
+    std::swap(allocation_, other.allocation_);
+    std::swap(size_, other.size_);
+    std::swap(order_, other.order_);
+    std::swap(release_proc_, other.release_proc_);
+  }
+
+  size_t GetBytesPerPixel() const { return sizeof(Color); }
+
+  size_t GetPixelCount() const { return size_.GetArea(); }
+
+  PixelOrder GetPixelOrder() const { return order_; }
+
+  const UPoint& GetSize() const { return size_; }
+
+  const uint8_t* GetAllocation(UPoint point = {}) const {
+    return allocation_ +
+           (static_cast<size_t>(size_.x) * point.y + point.x) *
+               GetBytesPerPixel();
+  }
+
+  uint8_t* GetAllocationMutable(UPoint point = {}) {
+    return const_cast<uint8_t*>(GetAllocation(point));
+  }
+
+  bool Resize(UPoint size);
+
+  bool CopyFromTexture(const Texture& texture);
+
+  bool CopyToTexture(Texture& texture) const;
+
+  void Grayscale();
+
+  void Invert();
+
+  void ColorMatrix(const Matrix& matrix);
+
+  void Sepia();
+
+  void Opacity(UnitScalarF opacity);
+
+  bool BoxBlur(const PackedTexture& src, uint8_t radius = 1u);
+
+  bool GaussianBlur(const PackedTexture& src, uint8_t radius, float sigma);
+
+  bool ConvolutionNxN(const PackedTexture& src,
+                      const std::vector<float>& kernel);
+
+ private:
+  uint8_t* allocation_ = nullptr;
+  UPoint size_ = {};
+  PixelOrder order_ = PixelOrder::kRGBA;
+  // Only set for allocations not made by the texture itself.
+  ReleaseProc release_proc_;
+
+  void ReleaseAllocation();
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(PackedTexture);
+};
+
+}  // namespace merle
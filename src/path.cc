@@ -0,0 +1,83 @@
+#include "path.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace merle {
+
+// Curves are never split into more lines than this.
+static constexpr ScalarF kMaxCurveSegments = 1024.0f;
+
+static ScalarF GetLength(PointF point) {
+  return std::hypot(point.x, point.y);
+}
+
+// The number of lines to split a curve into for them to stay within the
+// tolerance of it, given the largest second difference of its control points
+// and the factor the error of a curve of its degree grows with.
+static uint32_t GetCurveSegmentCount(ScalarF second_difference,
+                                     ScalarF factor) {
+  const auto count =
+      std::ceil(std::sqrt(factor * second_difference / Path::kTolerance));
+  return static_cast<uint32_t>(std::clamp(count, 1.0f, kMaxCurveSegments));
+}
+
+void Path::MoveTo(PointF point) {
+  Close();
+  start_ = point;
+  current_ = point;
+}
+
+void Path::LineTo(PointF point) {
+  segments_.push_back({current_, point});
+  current_ = point;
+}
+
+void Path::QuadTo(PointF control, PointF point) {
+  const auto p0 = current_;
+  const auto difference = GetLength({p0.x - 2.0f * control.x + point.x,
+                                     p0.y - 2.0f * control.y + point.y});
+  const auto count = GetCurveSegmentCount(difference, 0.25f);
+  for (uint32_t i = 1; i < count; i++) {
+    const auto t = static_cast<ScalarF>(i) / count;
+    const auto u = 1.0f - t;
+    LineTo({u * u * p0.x + 2.0f * u * t * control.x + t * t * point.x,
+            u * u * p0.y + 2.0f * u * t * control.y + t * t * point.y});
+  }
+  LineTo(point);
+}
+
+void Path::CubicTo(PointF control1, PointF control2, PointF point) {
+  const auto p0 = current_;
+  const auto difference = std::max(
+      GetLength({p0.x - 2.0f * control1.x + control2.x,
+                 p0.y - 2.0f * control1.y + control2.y}),
+      GetLength({control1.x - 2.0f * control2.x + point.x,
+                 control1.y - 2.0f * control2.y + point.y}));
+  const auto count = GetCurveSegmentCount(difference, 0.75f);
+  for (uint32_t i = 1; i < count; i++) {
+    const auto t = static_cast<ScalarF>(i) / count;
+    const auto u = 1.0f - t;
+    const auto a = u * u * u;
+    const auto b = 3.0f * u * u * t;
+    const auto c = 3.0f * u * t * t;
+    const auto d = t * t * t;
+    LineTo({a * p0.x + b * control1.x + c * control2.x + d * point.x,
+            a * p0.y + b * control1.y + c * control2.y + d * point.y});
+  }
+  LineTo(point);
+}
+
+void Path::Close() {
+  if (current_ != start_) {
+    LineTo(start_);
+  }
+}
+
+void Path::Reset() {
+  segments_.clear();
+  start_ = {};
+  current_ = {};
+}
+
+}  // namespace merle
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include "geom.h"
+#include "macros.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      An outline made of contours of lines and Bézier curves. Curves
+///             are flattened into lines as they are added.
+///
+///             Contours are closed when filled whether or not they were closed
+///             explicitly.
+///
+class Path {
+ public:
+  // How far, in pixels, the lines a curve is flattened into may stray from
+  // the curve.
+  static constexpr ScalarF kTolerance = 0.2f;
+
+  struct Segment {
+    PointF from;
+    PointF to;
+  };
+
+  Path() = default;
+
+  ~Path() = default;
+
+  Path(Path&& other) = default;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Start a new contour at the point. Closes the current one.
+  ///
+  void MoveTo(PointF point);
+
+  void LineTo(PointF point);
+
+  void QuadTo(PointF control, PointF point);
+
+  void CubicTo(PointF control1, PointF control2, PointF point);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Join the current contour back to its start. The next contour
+  ///             starts there too unless moved.
+  ///
+  void Close();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Remove every contour. The memory of the path is kept around.
+  ///
+  void Reset();
+
+  //----------------------------------------------------------------------------
+  /// @brief      The lines of the path. The current contour isn't closed.
+  ///
+  const std::vector<Segment>& GetSegments() const { return segments_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      The line that closes the current contour, which may be
+  ///             empty.
+  ///
+  Segment GetClosingSegment() const { return {current_, start_}; }
+
+ private:
+  std::vector<Segment> segments_;
+  PointF start_ = {};
+  PointF current_ = {};
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(Path);
+};
+
+}  // namespace merle
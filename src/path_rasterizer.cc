@@ -0,0 +1,100 @@
+#include "path_rasterizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "binning.h"
+#include "texture_ispc.h"
+
+namespace merle {
+
+PathRasterizer::PathRasterizer(UPoint size)
+    : size_(size), mask_(size.GetArea()) {}
+
+void PathRasterizer::Rasterize(const Path& path, FillRule rule) {
+  if (size_.GetArea() == 0u) {
+    return;
+  }
+  segments_.assign(path.GetSegments().begin(), path.GetSegments().end());
+  segments_.push_back(path.GetClosingSegment());
+
+  // The bands each line crosses the rows of. Horizontal lines and lines above
+  // or below the mask add nothing.
+  const uint32_t band_count = (size_.y + kBandHeight - 1u) / kBandHeight;
+  const auto for_each_band = [&](size_t index, auto&& proc) {
+    const auto& segment = segments_[index];
+    const auto top = std::max(
+        std::floor(std::min(segment.from.y, segment.to.y)), 0.0f);
+    const auto bottom =
+        std::min(std::ceil(std::max(segment.from.y, segment.to.y)),
+                 static_cast<ScalarF>(size_.y));
+    if (segment.from.y == segment.to.y || !(bottom > top)) {
+      return;
+    }
+    const auto first = static_cast<uint32_t>(top) / kBandHeight;
+    const auto last = (static_cast<uint32_t>(bottom) - 1u) / kBandHeight;
+    for (auto band = first; band <= last; band++) {
+      proc(band);
+    }
+  };
+
+  BinInOrder(band_count, segments_.size(), for_each_band, band_offsets_,
+             band_segments_);
+
+  const auto* segments =
+      reinterpret_cast<const ispc::PathSegment*>(segments_.data());
+  ispc::RasterizePath(segments,                   // segments
+                      band_offsets_.data(),       // band_offsets
+                      band_segments_.data(),      // band_segments
+                      mask_.data(),               // mask
+                      size_.x,                    // width
+                      size_.y,                    // height
+                      kBandHeight,                // band_height
+                      rule == FillRule::kEvenOdd  // even_odd
+  );
+}
+
+bool PathRasterizer::Fill(Texture& texture, Color color) const {
+  return FillLinearGradient(texture, {}, {}, color, color);
+}
+
+bool PathRasterizer::FillLinearGradient(Texture& texture,
+                                        PointF from,
+                                        PointF to,
+                                        Color from_color,
+                                        Color to_color) const {
+  if (texture.GetSize() != size_) {
+    return false;
+  }
+  // The position along the gradient is a linear function of the pixel
+  // center, zero at the start and one at the end.
+  const auto dx = to.x - from.x;
+  const auto dy = to.y - from.y;
+  const auto length_squared = dx * dx + dy * dy;
+  std::array<float, 3u> gradient = {};
+  if (length_squared > 0.0f) {
+    gradient = {dx / length_squared, dy / length_squared,
+                -(from.x * dx + from.y * dy) / length_squared};
+  }
+  if (!texture.MakePlanesUnique(kComponents)) {
+    return false;
+  }
+  std::array<uint8_t*, 4u> planes;
+  for (size_t i = 0; i < kComponents.size(); i++) {
+    planes[i] = texture.GetAllocationMutable(kComponents[i]);
+  }
+  const auto& start = reinterpret_cast<const ispc::Color&>(from_color);
+  const auto& end = reinterpret_cast<const ispc::Color&>(to_color);
+  ispc::FillMask(planes.data(),    // planes
+                 mask_.data(),     // mask
+                 size_.x,          // width
+                 size_.y,          // height
+                 gradient.data(),  // gradient
+                 start,            // from_color
+                 end               // to_color
+  );
+  return true;
+}
+
+}  // namespace merle
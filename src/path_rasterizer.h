@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "geom.h"
+#include "macros.h"
+#include "path.h"
+#include "rasterizer.h"
+#include "texture.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      Rasterizes paths with anti-aliasing into a mask of the coverage
+///             of each pixel and fills textures through the mask.
+///
+///             Each line of a path adds the signed area it sweeps to the
+///             right of it to an accumulation buffer. A running sum along
+///             each row then gives the winding of every pixel weighted by
+///             how much of it is covered. Lines are binned into bands of rows
+///             and the bands are rasterized with a task each, with a buffer of
+///             just the rows of its band.
+///
+class PathRasterizer {
+ public:
+  // The number of rows in each band lines are binned into.
+  static constexpr uint32_t kBandHeight = 16u;
+
+  explicit PathRasterizer(UPoint size);
+
+  ~PathRasterizer() = default;
+
+  PathRasterizer(PathRasterizer&& other) = default;
+
+  const UPoint& GetSize() const { return size_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Replace the mask with the coverage of the path. Every contour
+  ///             of the path is closed.
+  ///
+  void Rasterize(const Path& path, FillRule rule = FillRule::kNonZero);
+
+  //----------------------------------------------------------------------------
+  /// @brief      The coverage of each pixel out of 255, row by row.
+  ///
+  const uint8_t* GetMask() const { return mask_.data(); }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Composite a color source over the texture, scaled by the
+  ///             coverage of the mask.
+  ///
+  /// @return     If the texture is the size of the rasterizer.
+  ///
+  bool Fill(Texture& texture, Color color) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Composite a linear gradient source over the texture, scaled by
+  ///             the coverage of the mask. Past either end the gradient keeps
+  ///             the color of that end.
+  ///
+  /// @param      texture     The texture.
+  /// @param[in]  from        Where the gradient starts.
+  /// @param[in]  to          Where the gradient ends.
+  /// @param[in]  from_color  The color at the start.
+  /// @param[in]  to_color    The color at the end.
+  ///
+  /// @return     If the texture is the size of the rasterizer.
+  ///
+  bool FillLinearGradient(Texture& texture,
+                          PointF from,
+                          PointF to,
+                          Color from_color,
+                          Color to_color) const;
+
+ private:
+  UPoint size_;
+  std::vector<uint8_t> mask_;
+  // Scratch space for `Rasterize`, kept between calls.
+  std::vector<Path::Segment> segments_;
+  std::vector<uint32_t> band_offsets_;
+  std::vector<uint32_t> band_segments_;
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(PathRasterizer);
+};
+
+}  // namespace merle
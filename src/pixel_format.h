@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace merle {
+
+enum class ElementType : uint8_t {
+  // Normalized to [0, 1].
+  kU8,
+  // Normalized to [0, 1].
+  kU16,
+  // IEEE half floats. Stored as their bits in a uint16_t.
+  kF16,
+  kF32,
+};
+
+constexpr size_t GetElementSize(ElementType type) {
+  switch (type) {
+    case ElementType::kU8:
+      return 1u;
+    case ElementType::kU16:
+    case ElementType::kF16:
+      return 2u;
+    case ElementType::kF32:
+      return 4u;
+  }
+  return 0u;
+}
+
+//------------------------------------------------------------------------------
+/// @brief      The layout of the pixels of a `FormattedTexture`. Each channel
+///             is a plane of elements of the same type.
+///
+struct PixelFormat {
+  ElementType element_type = ElementType::kU8;
+  uint8_t channel_count = 4u;
+
+  constexpr size_t GetBytesPerElement() const {
+    return GetElementSize(element_type);
+  }
+
+  constexpr size_t GetBytesPerPixel() const {
+    return GetBytesPerElement() * channel_count;
+  }
+
+  constexpr bool operator==(const PixelFormat& other) const = default;
+};
+
+static constexpr PixelFormat kPixelFormatA8 = {ElementType::kU8, 1u};
+static constexpr PixelFormat kPixelFormatRGBA8 = {ElementType::kU8, 4u};
+static constexpr PixelFormat kPixelFormatR16 = {ElementType::kU16, 1u};
+static constexpr PixelFormat kPixelFormatRGBA16 = {ElementType::kU16, 4u};
+static constexpr PixelFormat kPixelFormatR16F = {ElementType::kF16, 1u};
+static constexpr PixelFormat kPixelFormatRGBA16F = {ElementType::kF16, 4u};
+static constexpr PixelFormat kPixelFormatR32F = {ElementType::kF32, 1u};
+static constexpr PixelFormat kPixelFormatRGBA32F = {ElementType::kF32, 4u};
+
+}  // namespace merle
@@ -0,0 +1,201 @@
+#include "rasterizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "binning.h"
+#include "texture_ispc.h"
+
+namespace merle {
+
+Rasterizer::Rasterizer(UPoint size) : size_(size) {}
+
+uint32_t Rasterizer::AddPaint(Color color) {
+  if (paints_.empty() || paints_.back() != color) {
+    paints_.push_back(color);
+  }
+  return static_cast<uint32_t>(paints_.size() - 1u);
+}
+
+void Rasterizer::AddSpan(int32_t y,
+                         ScalarF left,
+                         ScalarF right,
+                         uint32_t paint) {
+  if (y < 0 || y >= static_cast<int64_t>(size_.y)) {
+    return;
+  }
+  // The first pixels whose centers are at or past each edge.
+  const auto x_begin = std::clamp(std::ceil(left - 0.5f), 0.0f,
+                                  static_cast<ScalarF>(size_.x));
+  const auto x_end = std::clamp(std::ceil(right - 0.5f), 0.0f,
+                                static_cast<ScalarF>(size_.x));
+  if (!(x_end > x_begin)) {
+    return;
+  }
+  spans_.push_back({static_cast<int32_t>(x_begin), y,
+                    static_cast<int32_t>(x_end - x_begin), paint});
+}
+
+// The rows whose centers are in [top, bottom), clipped to the height.
+static std::pair<int32_t, int32_t> GetRowRange(ScalarF top,
+                                               ScalarF bottom,
+                                               uint32_t height) {
+  const auto first =
+      std::clamp(std::ceil(top - 0.5f), 0.0f, static_cast<ScalarF>(height));
+  const auto last =
+      std::clamp(std::ceil(bottom - 0.5f), 0.0f, static_cast<ScalarF>(height));
+  return {static_cast<int32_t>(first), static_cast<int32_t>(last)};
+}
+
+void Rasterizer::FillRect(const Rect& rect, Color color) {
+  const auto paint = AddPaint(color);
+  const auto ltrb = rect.GetLTRB();
+  const auto [first, last] = GetRowRange(ltrb[1], ltrb[3], size_.y);
+  for (auto y = first; y < last; y++) {
+    AddSpan(y, ltrb[0], ltrb[2], paint);
+  }
+}
+
+void Rasterizer::FillRoundRect(const Rect& rect, ScalarF radius, Color color) {
+  const auto paint = AddPaint(color);
+  const auto ltrb = rect.GetLTRB();
+  const auto left = static_cast<ScalarF>(ltrb[0]);
+  const auto top = static_cast<ScalarF>(ltrb[1]);
+  const auto right = static_cast<ScalarF>(ltrb[2]);
+  const auto bottom = static_cast<ScalarF>(ltrb[3]);
+  radius = std::clamp(radius, 0.0f, std::min(right - left, bottom - top) / 2);
+  const auto [first, last] = GetRowRange(top, bottom, size_.y);
+  for (auto y = first; y < last; y++) {
+    // The distance from the center of the row into the rows of the corners.
+    const auto center = y + 0.5f;
+    const auto dy =
+        std::max({top + radius - center, center - (bottom - radius), 0.0f});
+    const auto inset =
+        radius - std::sqrt(std::max(radius * radius - dy * dy, 0.0f));
+    AddSpan(y, left + inset, right - inset, paint);
+  }
+}
+
+void Rasterizer::FillCircle(PointF center, ScalarF radius, Color color) {
+  const auto paint = AddPaint(color);
+  const auto [first, last] =
+      GetRowRange(center.y - radius, center.y + radius, size_.y);
+  for (auto y = first; y < last; y++) {
+    const auto dy = y + 0.5f - center.y;
+    const auto half_width =
+        std::sqrt(std::max(radius * radius - dy * dy, 0.0f));
+    AddSpan(y, center.x - half_width, center.x + half_width, paint);
+  }
+}
+
+void Rasterizer::FillPolygon(const std::vector<PointF>& points,
+                             Color color,
+                             FillRule rule) {
+  if (points.size() < 3u) {
+    return;
+  }
+  const auto paint = AddPaint(color);
+
+  // Edges from top to bottom with the direction they wind in. Horizontal
+  // edges never cross the center of a row and are left out.
+  struct Edge {
+    PointF top;
+    PointF bottom;
+    int32_t winding;
+  };
+  std::vector<Edge> edges;
+  edges.reserve(points.size());
+  auto min_y = points[0].y;
+  auto max_y = points[0].y;
+  for (size_t i = 0; i < points.size(); i++) {
+    const auto& from = points[i];
+    const auto& to = points[(i + 1u) % points.size()];
+    min_y = std::min(min_y, from.y);
+    max_y = std::max(max_y, from.y);
+    if (from.y < to.y) {
+      edges.push_back({from, to, 1});
+    } else if (from.y > to.y) {
+      edges.push_back({to, from, -1});
+    }
+  }
+  std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+    return a.top.y < b.top.y;
+  });
+
+  // Walk the rows with the edges that span the center of each.
+  struct Crossing {
+    ScalarF x;
+    int32_t winding;
+  };
+  std::vector<const Edge*> active;
+  std::vector<Crossing> crossings;
+  size_t next_edge = 0;
+  const auto [first, last] = GetRowRange(min_y, max_y, size_.y);
+  for (auto y = first; y < last; y++) {
+    const auto center = y + 0.5f;
+    while (next_edge < edges.size() && edges[next_edge].top.y <= center) {
+      active.push_back(&edges[next_edge++]);
+    }
+    std::erase_if(active,
+                  [&](const Edge* edge) { return edge->bottom.y <= center; });
+    crossings.clear();
+    for (const auto* edge : active) {
+      const auto t = (center - edge->top.y) / (edge->bottom.y - edge->top.y);
+      crossings.push_back(
+          {edge->top.x + t * (edge->bottom.x - edge->top.x), edge->winding});
+    }
+    std::sort(crossings.begin(), crossings.end(),
+              [](const Crossing& a, const Crossing& b) { return a.x < b.x; });
+    int32_t winding = 0;
+    for (size_t i = 0; i + 1u < crossings.size(); i++) {
+      winding += rule == FillRule::kNonZero ? crossings[i].winding : 1;
+      const bool inside =
+          rule == FillRule::kNonZero ? winding != 0 : (winding & 1) != 0;
+      if (inside) {
+        AddSpan(y, crossings[i].x, crossings[i + 1u].x, paint);
+      }
+    }
+  }
+}
+
+void Rasterizer::Clear() {
+  spans_.clear();
+  paints_.clear();
+}
+
+bool Rasterizer::Draw(Texture& texture) {
+  if (texture.GetSize() != size_) {
+    return false;
+  }
+  if (spans_.empty()) {
+    return true;
+  }
+
+  const uint32_t band_count = (size_.y + kBandHeight - 1u) / kBandHeight;
+  BinInOrder(
+      band_count, spans_.size(),
+      [&](size_t index, auto&& proc) { proc(spans_[index].y / kBandHeight); },
+      band_offsets_, band_spans_);
+
+  if (!texture.MakePlanesUnique(kComponents)) {
+    return false;
+  }
+  std::array<uint8_t*, 4u> planes;
+  for (size_t i = 0; i < kComponents.size(); i++) {
+    planes[i] = texture.GetAllocationMutable(kComponents[i]);
+  }
+  const auto* spans = reinterpret_cast<const ispc::Span*>(spans_.data());
+  const auto* paints = reinterpret_cast<const ispc::Color*>(paints_.data());
+  ispc::FillSpans(planes.data(),         // planes
+                  size_.x,               // stride
+                  spans,                 // spans
+                  band_offsets_.data(),  // band_offsets
+                  band_spans_.data(),    // band_spans
+                  band_count,            // band_count
+                  paints                 // paints
+  );
+  return true;
+}
+
+}  // namespace merle
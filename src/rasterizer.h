@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "geom.h"
+#include "macros.h"
+#include "texture.h"
+
+namespace merle {
+
+// Which points are inside a shape whose outline crosses itself.
+enum class FillRule {
+  // Inside if the outline winds around the point any number of times.
+  kNonZero,
+  // Inside if a ray from the point crosses the outline an odd number of times.
+  kEvenOdd,
+};
+
+//------------------------------------------------------------------------------
+/// @brief      Fills shapes into a texture of a given size.
+///
+///             Each fill call turns its shape into horizontal spans of pixels,
+///             one per run of covered pixels on a row. A pixel is covered if
+///             its center is in the shape. `Draw` bins the spans into bands
+///             of rows and fills the bands in a single launch with a task per
+///             band. Opaque spans are filled with plain stores to each plane
+///             and translucent ones are composited source over.
+///
+///             Within a band spans are filled in the order they were added, so
+///             later shapes land on top of earlier ones.
+///
+class Rasterizer {
+ public:
+  // The number of rows in each band spans are binned into.
+  static constexpr uint32_t kBandHeight = 16u;
+
+  explicit Rasterizer(UPoint size);
+
+  ~Rasterizer() = default;
+
+  Rasterizer(Rasterizer&& other) = default;
+
+  const UPoint& GetSize() const { return size_; }
+
+  size_t GetSpanCount() const { return spans_.size(); }
+
+  void FillRect(const Rect& rect, Color color);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Fill a rectangle with rounded corners.
+  ///
+  /// @param[in]  rect    The rectangle.
+  /// @param[in]  radius  The radius of the corners. Clamped to half the
+  ///                     shorter side of the rectangle.
+  /// @param[in]  color   The color.
+  ///
+  void FillRoundRect(const Rect& rect, ScalarF radius, Color color);
+
+  void FillCircle(PointF center, ScalarF radius, Color color);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Fill a polygon.
+  ///
+  /// @param[in]  points  The vertices of the polygon. The last one is joined
+  ///                     back to the first. May cross itself.
+  /// @param[in]  color   The color.
+  /// @param[in]  rule    Which parts of a polygon that crosses itself are
+  ///                     filled.
+  ///
+  void FillPolygon(const std::vector<PointF>& points,
+                   Color color,
+                   FillRule rule = FillRule::kNonZero);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Remove every shape. The memory of the rasterizer is kept
+  ///             around for the next frame.
+  ///
+  void Clear();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Fill every shape into the texture.
+  ///
+  /// @return     If the texture is the size of the rasterizer.
+  ///
+  bool Draw(Texture& texture);
+
+ private:
+  // Must match the layout of Span in texture.ispc.
+  struct Span {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    uint32_t paint;
+  };
+
+  UPoint size_;
+  std::vector<Span> spans_;
+  std::vector<Color> paints_;
+  // Scratch space for `Draw`, kept between frames.
+  std::vector<uint32_t> band_offsets_;
+  std::vector<uint32_t> band_spans_;
+
+  uint32_t AddPaint(Color color);
+
+  // Add the pixels of a row whose centers are in [left, right).
+  void AddSpan(int32_t y, ScalarF left, ScalarF right, uint32_t paint);
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(Rasterizer);
+};
+
+}  // namespace merle
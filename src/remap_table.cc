@@ -0,0 +1,55 @@
+#include "remap_table.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace merle {
+
+bool RemapTable::Build(UPoint size, UPoint src_size, const MapProc& map) {
+  if (src_size.x > kMaxSourceSize || src_size.y > kMaxSourceSize) {
+    return false;
+  }
+  points_.resize(size.GetArea());
+  fractions_.resize(size.GetArea());
+  size_ = size;
+  src_size_ = src_size;
+
+  constexpr float kOne = 1u << kFractionBits;
+  constexpr uint32_t kFractionMask = (1u << kFractionBits) - 1u;
+  size_t i = 0;
+  for (uint32_t y = 0; y < size.y; y++) {
+    for (uint32_t x = 0; x < size.x; x++, i++) {
+      const auto point = map({x + 0.5f, y + 0.5f});
+      if (!(point.x >= 0.0f && point.x < src_size.x && point.y >= 0.0f &&
+            point.y < src_size.y)) {
+        points_[i] = kOutside;
+        fractions_[i] = 0u;
+        continue;
+      }
+      // Relative to the centers of the source pixels, clamped to the edge
+      // ones. Rounding may carry into the next pixel.
+      const auto fixed_x = static_cast<uint32_t>(std::lround(
+          std::clamp(point.x - 0.5f, 0.0f, src_size.x - 1.0f) * kOne));
+      const auto fixed_y = static_cast<uint32_t>(std::lround(
+          std::clamp(point.y - 0.5f, 0.0f, src_size.y - 1.0f) * kOne));
+      points_[i] =
+          ((fixed_x >> kFractionBits) << 16u) | (fixed_y >> kFractionBits);
+      fractions_[i] = static_cast<uint16_t>(
+          ((fixed_x & kFractionMask) << 8u) | (fixed_y & kFractionMask));
+    }
+  }
+  return true;
+}
+
+bool RemapTable::Build(UPoint size,
+                       UPoint src_size,
+                       const Transform& transform) {
+  const auto inverse = transform.Invert();
+  if (!inverse.has_value()) {
+    return false;
+  }
+  return Build(size, src_size,
+               [&](PointF point) { return inverse->Map(point); });
+}
+
+}  // namespace merle
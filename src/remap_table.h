@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+#include "geom.h"
+#include "macros.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      For each pixel of a destination, the point of a source to sample
+///             it from. Build a table once and use it with `Texture::Remap` to
+///             apply the same map, say a lens undistortion, to every frame of
+///             a video without evaluating the map again.
+///
+///             Points are stored in fixed point with `kFractionBits` bits
+///             below the pixel. Each holds the top left of the 2x2 block of
+///             source pixels to filter and the weights of the pixels to its
+///             right and below.
+///
+class RemapTable {
+ public:
+  static constexpr uint32_t kFractionBits = 8u;
+
+  // The largest width or height of a source.
+  static constexpr uint32_t kMaxSourceSize = UINT16_MAX;
+
+  // Marks destination pixels whose source point is outside the source.
+  static constexpr uint32_t kOutside = UINT32_MAX;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Maps the center of a destination pixel to a point in the
+  ///             source. Both are in pixels with the centers of pixels at
+  ///             halves.
+  ///
+  using MapProc = std::function<PointF(PointF point)>;
+
+  RemapTable() = default;
+
+  ~RemapTable() = default;
+
+  RemapTable(RemapTable&& other) = default;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Build the table by calling the map for every destination
+  ///             pixel.
+  ///
+  /// @param[in]  size      The size of the destination.
+  /// @param[in]  src_size  The size of the source. Neither side may be larger
+  ///                       than `kMaxSourceSize`.
+  /// @param[in]  map       The map.
+  ///
+  /// @return     If the table could be built.
+  ///
+  bool Build(UPoint size, UPoint src_size, const MapProc& map);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Build the table for the same warp as `Texture::Warp`.
+  ///
+  /// @param[in]  transform  Maps points of the source to points of the
+  ///                        destination.
+  ///
+  /// @return     If the table could be built and the transform inverted.
+  ///
+  bool Build(UPoint size, UPoint src_size, const Transform& transform);
+
+  const UPoint& GetSize() const { return size_; }
+
+  const UPoint& GetSourceSize() const { return src_size_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      One per destination pixel. The x of the top left source pixel
+  ///             in the high 16 bits and the y in the low ones, or `kOutside`.
+  ///
+  const uint32_t* GetPoints() const { return points_.data(); }
+
+  //----------------------------------------------------------------------------
+  /// @brief      One per destination pixel. The weight of the right column in
+  ///             the high byte and of the bottom row in the low one, out of
+  ///             `1 << kFractionBits`.
+  ///
+  const uint16_t* GetFractions() const { return fractions_.data(); }
+
+ private:
+  UPoint size_ = {};
+  UPoint src_size_ = {};
+  std::vector<uint32_t> points_;
+  std::vector<uint16_t> fractions_;
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(RemapTable);
+};
+
+}  // namespace merle
@@ -0,0 +1,56 @@
+#include "rgb565_texture.h"
+
+#include <cstdlib>
+
+#include "texture_ispc.h"
+
+namespace merle {
+
+RGB565Texture::~RGB565Texture() {
+  std::free(allocation_);
+}
+
+RGB565Texture::RGB565Texture(RGB565Texture&& other) {
+  std::swap(allocation_, other.allocation_);
+  std::swap(size_, other.size_);
+}
+
+bool RGB565Texture::Resize(UPoint size) {
+  if (size_ == size) {
+    return true;
+  }
+  auto allocation = reinterpret_cast<uint16_t*>(
+      std::malloc(size.GetArea() * GetBytesPerPixel()));
+  if (allocation == nullptr) {
+    return false;
+  }
+  std::free(allocation_);
+  allocation_ = allocation;
+  size_ = size;
+  return true;
+}
+
+bool RGB565Texture::CopyFromTexture(const Texture& texture, bool dither) {
+  if (texture.GetSize() != size_) {
+    return false;
+  }
+  texture.CopyToRGB565(allocation_, dither);
+  return true;
+}
+
+bool RGB565Texture::CopyToTexture(Texture& texture) const {
+  if (texture.GetSize() != size_ ||
+      !texture.MakePlanesUnique(kComponents, /*preserve_contents=*/false)) {
+    return false;
+  }
+  ispc::FromRGB565(allocation_,                // rgb565
+                   texture.GetRedMutable(),    // red
+                   texture.GetGreenMutable(),  // green
+                   texture.GetBlueMutable(),   // blue
+                   texture.GetAlphaMutable(),  // alpha
+                   GetPixelCount()             // length
+  );
+  return true;
+}
+
+}  // namespace merle
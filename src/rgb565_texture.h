@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "geom.h"
+#include "macros.h"
+#include "texture.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      A texture of opaque 16-bit RGB565 pixels. At half the size of a
+///             `Texture` and in the format many displays scan out, it suits
+///             memory bound preview paths. Filtering is done on a `Texture`
+///             that is then packed into one of these.
+///
+class RGB565Texture {
+ public:
+  RGB565Texture() = default;
+
+  ~RGB565Texture();
+
+  RGB565Texture(RGB565Texture&& other);
+
+  size_t GetBytesPerPixel() const { return sizeof(uint16_t); }
+
+  size_t GetPixelCount() const { return size_.GetArea(); }
+
+  const UPoint& GetSize() const { return size_; }
+
+  const uint16_t* GetAllocation(UPoint point = {}) const {
+    return allocation_ + static_cast<size_t>(size_.x) * point.y + point.x;
+  }
+
+  uint16_t* GetAllocationMutable(UPoint point = {}) {
+    return const_cast<uint16_t*>(GetAllocation(point));
+  }
+
+  bool Resize(UPoint size);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Pack a texture of the same size into this one.
+  ///
+  /// @param[in]  texture  The texture to pack. Alpha is dropped.
+  /// @param[in]  dither   Whether to apply ordered dithering.
+  ///
+  bool CopyFromTexture(const Texture& texture, bool dither = false);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Expand the pixels into a texture of the same size. The
+  ///             texture is made opaque.
+  ///
+  bool CopyToTexture(Texture& texture) const;
+
+ private:
+  uint16_t* allocation_ = nullptr;
+  UPoint size_ = {};
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(RGB565Texture);
+};
+
+}  // namespace merle
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "texture.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      A copyable handle to a texture. Copies are cheap and share
+///             planes with each other. The first write to a shared plane via
+///             `GetMutable` copies just that plane. So, a filter that only
+///             touches the alpha channel of a copy only ever duplicates the
+///             alpha plane.
+///
+///             A handle may be used on a different thread than its copies but
+///             the same handle may not be used on multiple threads at once.
+///
+class SharedTexture {
+ public:
+  SharedTexture() = default;
+
+  explicit SharedTexture(Texture texture) : texture_(std::move(texture)) {}
+
+  ~SharedTexture() = default;
+
+  SharedTexture(const SharedTexture& other)
+      : texture_(other.texture_.Clone()) {}
+
+  SharedTexture& operator=(const SharedTexture& other) {
+    texture_ = other.texture_.Clone();
+    return *this;
+  }
+
+  SharedTexture(SharedTexture&& other) = default;
+
+  SharedTexture& operator=(SharedTexture&& other) = default;
+
+  const Texture& Get() const { return texture_; }
+
+  const Texture& operator*() const { return texture_; }
+
+  const Texture* operator->() const { return &texture_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Get the texture for filters that modify it in place or write
+  ///             into it. Planes shared with other handles are copied as they
+  ///             are written to.
+  ///
+  Texture& GetMutable() { return texture_; }
+
+ private:
+  Texture texture_;
+};
+
+}  // namespace merle
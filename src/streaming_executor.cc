@@ -0,0 +1,86 @@
+#include "streaming_executor.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <future>
+
+namespace merle {
+
+bool StreamingExecutor::Run(const OpChain& chain,
+                            const ReadProc& read,
+                            const WriteProc& write) const {
+  const auto strip_count = GetStripCount();
+  if (strip_count == 0u) {
+    return image_size_.y == 0u;
+  }
+  const auto halo = chain.GetHalo();
+
+  // The first row of the image read into the strip.
+  auto get_read_top = [&](uint32_t strip) -> uint32_t {
+    const auto top = strip * strip_height_;
+    return top > halo ? top - halo : 0u;
+  };
+
+  auto read_strip = [&](uint32_t strip, Texture* input) -> bool {
+    const auto top = get_read_top(strip);
+    const auto end = static_cast<uint64_t>(strip + 1u) * strip_height_ + halo;
+    const auto bottom =
+        static_cast<uint32_t>(std::min<uint64_t>(end, image_size_.y));
+    if (!input->Resize({image_size_.x, bottom - top})) {
+      return false;
+    }
+    return read(top, *input);
+  };
+
+  // While one of each is in use by the chain, the other is being read into or
+  // written from.
+  std::array<Texture, 2u> inputs;
+  std::array<Texture, 2u> outputs;
+  // Declared after the textures so that pending reads and writes are waited
+  // on before the textures go away.
+  std::future<bool> reading =
+      std::async(std::launch::async, read_strip, 0u, &inputs[0u]);
+  std::future<bool> writing;
+
+  for (uint32_t strip = 0u; strip < strip_count; strip++) {
+    if (!reading.get()) {
+      return false;
+    }
+    if (strip + 1u < strip_count) {
+      reading = std::async(std::launch::async, read_strip, strip + 1u,
+                           &inputs[(strip + 1u) % 2u]);
+    }
+
+    auto& input = inputs[strip % 2u];
+    if (!chain.Run(input)) {
+      return false;
+    }
+
+    // Drop the halo rows. Strips span the width of the image so the rows to
+    // keep are contiguous in each plane.
+    const auto top = strip * strip_height_;
+    const auto rows = std::min(strip_height_, image_size_.y - top);
+    auto& output = outputs[strip % 2u];
+    if (!output.Resize({image_size_.x, rows}) ||
+        !output.MakePlanesUnique(kComponents)) {
+      return false;
+    }
+    for (auto comp : kComponents) {
+      ::memcpy(output.GetAllocationMutable(comp),
+               input.GetAllocation(comp, {0u, top - get_read_top(strip)}),
+               output.GetPixelCount());
+    }
+
+    if (writing.valid() && !writing.get()) {
+      return false;
+    }
+    writing = std::async(std::launch::async, [&write, top, &output]() {
+      return write(top, output);
+    });
+  }
+
+  return writing.get();
+}
+
+}  // namespace merle
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+
+#include "geom.h"
+#include "macros.h"
+#include "op_chain.h"
+#include "texture.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      Runs an op chain over an image too large to keep in memory.
+///
+///             The image is read in horizontal strips along with the halo rows
+///             the chain needs above and below each one. While a strip is run
+///             through the chain, the next one is read and the previous one is
+///             written out. Only a fixed number of strips are resident at
+///             once, so peak memory depends on the width of the image, the
+///             strip height and the halo but not the height of the image.
+///
+class StreamingExecutor {
+ public:
+  //----------------------------------------------------------------------------
+  /// @brief      Fill the texture with the rows of the image starting at row
+  ///             `y`. The texture is as wide as the image.
+  ///
+  using ReadProc = std::function<bool(uint32_t y, Texture& rows)>;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Write the rows of the texture out as the rows of the image
+  ///             starting at row `y`.
+  ///
+  using WriteProc = std::function<bool(uint32_t y, const Texture& rows)>;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Create an executor for images of the given size.
+  ///
+  /// @param[in]  image_size    The size of the image.
+  /// @param[in]  strip_height  The number of rows of output computed at a
+  ///                           time. Taller strips re-read fewer halo rows but
+  ///                           take more memory.
+  ///
+  StreamingExecutor(UPoint image_size, uint32_t strip_height)
+      : image_size_(image_size), strip_height_(strip_height) {}
+
+  ~StreamingExecutor() = default;
+
+  const UPoint& GetImageSize() const { return image_size_; }
+
+  uint32_t GetStripHeight() const { return strip_height_; }
+
+  uint32_t GetStripCount() const {
+    return strip_height_ == 0u
+               ? 0u
+               : (image_size_.y + strip_height_ - 1u) / strip_height_;
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Read the image, run it through the chain and write it out.
+  ///             Rows are written in order. The procs are called on threads
+  ///             other than the caller's, though never more than one of each
+  ///             at a time.
+  ///
+  /// @return     If every strip was read, processed and written.
+  ///
+  bool Run(const OpChain& chain,
+           const ReadProc& read,
+           const WriteProc& write) const;
+
+ private:
+  const UPoint image_size_;
+  const uint32_t strip_height_;
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(StreamingExecutor);
+};
+
+}  // namespace merle
@@ -1,12 +1,30 @@
 #include <gtest/gtest.h>
 
 #include <imgui.h>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <vector>
 #include "application.h"
+#include "band_executor.h"
+#include "blit_batch.h"
 #include "fixtures_location.h"
+#include "formatted_texture.h"
 #include "geom.h"
+#include "op_chain.h"
+#include "packed_texture.h"
+#include "path.h"
+#include "path_rasterizer.h"
+#include "rasterizer.h"
+#include "remap_table.h"
+#include "rgb565_texture.h"
+#include "shared_texture.h"
+#include "streaming_executor.h"
 #include "test_runner.h"
 #include "texture.h"
+#include "texture_batch.h"
+#include "tiled_texture.h"
 
 namespace merle {
 
@@ -188,6 +206,85 @@ TEST_F(MerleTest, Swizzle) {
   ASSERT_TRUE(Run(application));
 }
 
+TEST_F(MerleTest, SwizzleSharesPlanes) {
+  Texture texture;
+  ASSERT_TRUE(texture.Resize({64, 64}));
+  texture.Clear(Color{1, 2, 3, 4});
+  texture.Swizzle(Component::kAlpha,  //
+                  Component::kRed,    //
+                  Component::kGreen,  //
+                  Component::kAlpha   //
+  );
+  ASSERT_EQ(texture.GetRed(), texture.GetAlpha());
+  ASSERT_EQ(texture.GetGreen()[0], 1u);
+  ASSERT_EQ(texture.GetBlue()[0], 2u);
+  // Writing to one of the components sharing a plane detaches it.
+  texture.GetRedMutable()[0] = 9u;
+  ASSERT_NE(texture.GetRed(), texture.GetAlpha());
+  ASSERT_EQ(texture.GetRed()[0], 9u);
+  ASSERT_EQ(texture.GetRed()[1], 4u);
+  ASSERT_EQ(texture.GetAlpha()[0], 4u);
+
+  texture.DuplicateChannel(Component::kGreen, Component::kBlue);
+  ASSERT_EQ(texture.GetGreen(), texture.GetBlue());
+  texture.Invert();
+  ASSERT_EQ(texture.GetGreen()[0], 254u);
+  ASSERT_EQ(texture.GetBlue()[0], 254u);
+}
+
+TEST_F(MerleTest, MakePlanesUniqueCopiesSharedPlanes) {
+  Texture texture;
+  ASSERT_TRUE(texture.Resize({64, 64}));
+  texture.Clear(Color{1, 2, 3, 4});
+  auto clone = texture.Clone();
+  ASSERT_TRUE(clone.MakePlanesUnique(kColorComponents));
+  ASSERT_NE(clone.GetRed(), texture.GetRed());
+  ASSERT_NE(clone.GetBlue(), texture.GetBlue());
+  ASSERT_EQ(clone.GetAlpha(), texture.GetAlpha());
+  ASSERT_EQ(clone.GetRed()[0], 1u);
+  ASSERT_EQ(clone.GetBlue()[4095], 3u);
+  // Planes that are already unique are left in place.
+  const auto* red = clone.GetRed();
+  ASSERT_TRUE(clone.MakePlaneUnique(Component::kRed));
+  ASSERT_EQ(clone.GetRed(), red);
+}
+
+TEST_F(MerleTest, WholePlaneWritersReplaceSharedPlanes) {
+  Texture texture;
+  ASSERT_TRUE(texture.Resize({64, 64}));
+  texture.Clear(kColorRed);
+  auto clone = texture.Clone();
+  clone.Clear(kColorBlue, true, true, true, false);
+  ASSERT_NE(clone.GetRed(), texture.GetRed());
+  ASSERT_EQ(clone.GetAlpha(), texture.GetAlpha());
+  ASSERT_EQ(clone.AverageColor(), kColorBlue);
+  ASSERT_EQ(texture.AverageColor(), kColorRed);
+
+  auto flipped = texture.Clone();
+  ASSERT_TRUE(flipped.Flip(clone, Texture::Direction::kHorizontal));
+  ASSERT_EQ(flipped.AverageColor(), kColorBlue);
+  ASSERT_EQ(texture.AverageColor(), kColorRed);
+}
+
+TEST_F(MerleTest, SharedTextureCopyOnWrite) {
+  Texture texture;
+  ASSERT_TRUE(texture.Resize({64, 64}));
+  texture.Clear(kColorFuchsia);
+  SharedTexture original(std::move(texture));
+  SharedTexture copy = original;
+  ASSERT_EQ(copy->GetRed(), original->GetRed());
+  ASSERT_EQ(copy->GetAlpha(), original->GetAlpha());
+
+  copy.GetMutable().Opacity(0.0f);
+  // Only the alpha plane is copied.
+  ASSERT_EQ(copy->GetRed(), original->GetRed());
+  ASSERT_EQ(copy->GetGreen(), original->GetGreen());
+  ASSERT_EQ(copy->GetBlue(), original->GetBlue());
+  ASSERT_NE(copy->GetAlpha(), original->GetAlpha());
+  ASSERT_EQ(copy->AverageColor(), kColorFuchsia.WithAlpha(0));
+  ASSERT_EQ(original->AverageColor(), kColorFuchsia);
+}
+
 TEST_F(MerleTest, Sepia) {
   Application application;
   auto texture = std::make_shared<Texture>();
@@ -416,6 +513,25 @@ TEST_F(MerleTest, Sobel) {
   ASSERT_TRUE(Run(application));
 }
 
+TEST_F(MerleTest, NeighborhoodFiltersLeaveShortTexturesAlone) {
+  // Too short for any output row, and shorter than the core count.
+  for (auto size : {UPoint{40u, 1u}, UPoint{40u, 2u}}) {
+    Texture src;
+    Texture dst;
+    ASSERT_TRUE(src.Resize(size));
+    ASSERT_TRUE(dst.Resize(size));
+    src.Clear(kColorWhite);
+    dst.Clear(kColorRed);
+    ASSERT_TRUE(dst.GaussianBlur(src, 3u, 1.5f));
+    ASSERT_TRUE(dst.Sobel(src, Component::kGreen, Component::kBlue));
+    for (size_t i = 0; i < dst.GetPixelCount(); i++) {
+      ASSERT_EQ(dst.GetAllocation(Component::kRed)[i], 255u);
+      ASSERT_EQ(dst.GetAllocation(Component::kGreen)[i], 0u);
+      ASSERT_EQ(dst.GetAllocation(Component::kBlue)[i], 0u);
+    }
+  }
+}
+
 static std::shared_ptr<Texture> CreateSizedImage(const char* path,
                                                  UPoint size,
                                                  Color bg_color) {
@@ -501,6 +617,1334 @@ TEST_F(MerleTest, AverageColor) {
   ASSERT_EQ(texture.AverageColor().alpha, kColorFuchsia.alpha);
 }
 
+TEST_F(MerleTest, AreaDoesNotOverflow) {
+  const UPoint size = {1u << 16, (1u << 16) + 1u};
+  ASSERT_EQ(size.GetArea(), (uint64_t{1} << 32) + (uint64_t{1} << 16));
+  const Point signed_size = {-(1 << 16), 1 << 16};
+  ASSERT_EQ(signed_size.GetArea(), -(int64_t{1} << 32));
+}
+
+TEST_F(MerleTest, AdoptAllocation) {
+  const UPoint size = {64, 32};
+  auto allocation =
+      reinterpret_cast<uint8_t*>(std::malloc(size.GetArea() * sizeof(Color)));
+  ASSERT_NE(allocation, nullptr);
+  ::memset(allocation, 0, size.GetArea() * sizeof(Color));
+  bool released = false;
+  {
+    Texture texture(allocation, size, [&](uint8_t* allocation) {
+      released = true;
+      std::free(allocation);
+    });
+    texture.Invert();
+    ASSERT_EQ(texture.GetRed(), allocation);
+    ASSERT_EQ(allocation[0], 255u);
+    ASSERT_FALSE(released);
+  }
+  ASSERT_TRUE(released);
+}
+
+TEST_F(MerleTest, BorrowAllocation) {
+  const UPoint size = {64, 32};
+  std::vector<uint8_t> allocation(size.GetArea() * sizeof(Color));
+  {
+    auto texture = Texture::Borrow(allocation.data(), size);
+    texture.Clear(kColorFuchsia);
+    // Resizing a borrowed texture must leave the borrowed memory alone.
+    ASSERT_TRUE(texture.Resize({16, 16}));
+    ASSERT_NE(texture.GetRed(), allocation.data());
+  }
+  ASSERT_EQ(allocation.front(), kColorFuchsia.red);
+  ASSERT_EQ(allocation.back(), kColorFuchsia.alpha);
+}
+
+static bool TexturesEqual(const Texture& a, const Texture& b) {
+  return a.GetSize() == b.GetSize() &&
+         ::memcmp(a.GetRed(), b.GetRed(), a.GetPixelCount()) == 0 &&
+         ::memcmp(a.GetGreen(), b.GetGreen(), a.GetPixelCount()) == 0 &&
+         ::memcmp(a.GetBlue(), b.GetBlue(), a.GetPixelCount()) == 0 &&
+         ::memcmp(a.GetAlpha(), b.GetAlpha(), a.GetPixelCount()) == 0;
+}
+
+// Whether the textures are the same size and no components are more than the
+// tolerance apart.
+static bool TexturesNear(const Texture& a, const Texture& b, int tolerance) {
+  if (a.GetSize() != b.GetSize()) {
+    return false;
+  }
+  for (auto comp : kComponents) {
+    for (size_t i = 0; i < a.GetPixelCount(); i++) {
+      if (std::abs(a.GetAllocation(comp)[i] - b.GetAllocation(comp)[i]) >
+          tolerance) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST_F(MerleTest, PackedMatchesPlanar) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  image->Opacity(0.75f);
+  for (auto order : {PixelOrder::kRGBA, PixelOrder::kBGRA}) {
+    PackedTexture packed(order);
+    ASSERT_TRUE(packed.Resize(image->GetSize()));
+    ASSERT_TRUE(packed.CopyFromTexture(*image));
+    PackedTexture packed_blur(order);
+    ASSERT_TRUE(packed_blur.Resize(image->GetSize()));
+    ASSERT_TRUE(packed_blur.CopyFromTexture(*image));
+    Texture planar_blur;
+    ASSERT_TRUE(planar_blur.Resize(image->GetSize()));
+    ASSERT_TRUE(packed_blur.CopyToTexture(planar_blur));
+
+    image->Sepia();
+    image->Grayscale();
+    image->Invert();
+    image->Opacity(0.5f);
+    packed.Sepia();
+    packed.Grayscale();
+    packed.Invert();
+    packed.Opacity(0.5f);
+
+    planar_blur.GaussianBlur(*image, 2, 3.0f);
+    packed_blur.GaussianBlur(packed, 2, 3.0f);
+
+    Texture unpacked;
+    ASSERT_TRUE(unpacked.Resize(image->GetSize()));
+    ASSERT_TRUE(packed.CopyToTexture(unpacked));
+    ASSERT_TRUE(TexturesEqual(unpacked, *image));
+    ASSERT_TRUE(packed_blur.CopyToTexture(unpacked));
+    ASSERT_TRUE(TexturesEqual(unpacked, planar_blur));
+  }
+}
+
+TEST_F(MerleTest, TiledMatchesLinear) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  auto other = Texture::CreateFromFile(NS_ASSETS_LOCATION "kalimba.jpg");
+  ASSERT_TRUE(other.has_value());
+  // Not a multiple of the tile size in either direction.
+  const UPoint size = {333, 222};
+  Texture src, src2, linear;
+  ASSERT_TRUE(src.Resize(size));
+  ASSERT_TRUE(src2.Resize(size));
+  ASSERT_TRUE(linear.Resize(size));
+  src.Clear(kColorBlack);
+  src.Replace(*image, {});
+  src2.Clear(kColorBlack);
+  src2.Replace(*other, {});
+
+  TiledTexture tiled_src, tiled_src2, tiled;
+  ASSERT_TRUE(tiled_src.Resize(size));
+  ASSERT_TRUE(tiled_src2.Resize(size));
+  ASSERT_TRUE(tiled.Resize(size));
+  ASSERT_TRUE(tiled_src.CopyFromTexture(src));
+  ASSERT_TRUE(tiled_src2.CopyFromTexture(src2));
+
+  Texture untiled;
+  ASSERT_TRUE(untiled.Resize(size));
+  ASSERT_TRUE(tiled_src.CopyToTexture(untiled));
+  ASSERT_TRUE(TexturesEqual(untiled, src));
+
+  linear.Clear(kColorRed);
+  tiled.Clear(kColorRed);
+  ASSERT_TRUE(linear.GaussianBlur(src, 3, 2.0f));
+  ASSERT_TRUE(tiled.GaussianBlur(tiled_src, 3, 2.0f));
+  ASSERT_TRUE(tiled.CopyToTexture(untiled));
+  ASSERT_TRUE(TexturesEqual(untiled, linear));
+
+  ASSERT_TRUE(linear.Sobel(src, Component::kGreen, Component::kBlue));
+  ASSERT_TRUE(tiled.Sobel(tiled_src, Component::kGreen, Component::kBlue));
+  ASSERT_TRUE(tiled.CopyToTexture(untiled));
+  ASSERT_TRUE(TexturesEqual(untiled, linear));
+
+  for (auto direction :
+       {Texture::Direction::kHorizontal, Texture::Direction::kVertical}) {
+    ASSERT_TRUE(linear.SwipeTransition(src, src2, 0.4f, direction));
+    ASSERT_TRUE(tiled.SwipeTransition(tiled_src, tiled_src2, 0.4f, direction));
+    ASSERT_TRUE(tiled.CopyToTexture(untiled));
+    ASSERT_TRUE(TexturesEqual(untiled, linear));
+  }
+}
+
+TEST_F(MerleTest, SparseTiledMatchesLinear) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  Texture patch;
+  ASSERT_TRUE(patch.Resize({40, 40}));
+  patch.Replace(*image, {});
+
+  const UPoint size = {700, 500};
+  Texture linear, linear_blur, untiled;
+  ASSERT_TRUE(linear.Resize(size));
+  ASSERT_TRUE(linear_blur.Resize(size));
+  ASSERT_TRUE(untiled.Resize(size));
+  linear.Clear(kColorTransparentBlack);
+  linear.Replace(patch, {300, 200});
+
+  TiledTexture sparse(TiledTexture::Storage::kSparse);
+  ASSERT_TRUE(sparse.Resize(size));
+  ASSERT_EQ(sparse.GetResidentTileCount(), 0u);
+  sparse.Clear(kColorTransparentBlack);
+  ASSERT_TRUE(sparse.Replace(patch, {300, 200}));
+  // The patch straddles two tiles horizontally.
+  ASSERT_EQ(sparse.GetResidentTileCount(), 2u);
+  ASSERT_TRUE(sparse.IsTileResident({4, 3}));
+  ASSERT_TRUE(sparse.IsTileResident({5, 3}));
+  ASSERT_TRUE(sparse.CopyToTexture(untiled));
+  ASSERT_TRUE(TexturesEqual(untiled, linear));
+  ASSERT_EQ(sparse.AverageColor(), linear.AverageColor());
+  ASSERT_FALSE(sparse.IsOpaque());
+
+  linear.Invert();
+  sparse.Invert();
+  ASSERT_EQ(sparse.GetResidentTileCount(), 2u);
+  ASSERT_TRUE(sparse.CopyToTexture(untiled));
+  ASSERT_TRUE(TexturesEqual(untiled, linear));
+  ASSERT_EQ(sparse.AverageColor(), linear.AverageColor());
+
+  linear_blur.Clear(kColorRed);
+  TiledTexture sparse_blur(TiledTexture::Storage::kSparse);
+  ASSERT_TRUE(sparse_blur.Resize(size));
+  sparse_blur.Clear(kColorRed);
+  ASSERT_TRUE(linear_blur.GaussianBlur(linear, 3, 2.0f));
+  ASSERT_TRUE(sparse_blur.GaussianBlur(sparse, 3, 2.0f));
+  ASSERT_LT(sparse_blur.GetResidentTileCount(),
+            sparse_blur.GetTileCount().GetArea());
+  ASSERT_TRUE(sparse_blur.CopyToTexture(untiled));
+  ASSERT_TRUE(TexturesEqual(untiled, linear_blur));
+
+  ASSERT_TRUE(linear_blur.Sobel(linear, Component::kGreen, Component::kBlue));
+  ASSERT_TRUE(sparse_blur.Sobel(sparse, Component::kGreen, Component::kBlue));
+  ASSERT_TRUE(sparse_blur.CopyToTexture(untiled));
+  ASSERT_TRUE(TexturesEqual(untiled, linear_blur));
+
+  // Offsets may be negative.
+  ASSERT_TRUE(sparse.Replace(patch, {-10, -10}));
+  ASSERT_EQ(sparse.GetResidentTileCount(), 3u);
+  ASSERT_EQ(sparse.GetTile({0, 0}, Component::kGreen)[0],
+            patch.GetAllocation(Component::kGreen, {10, 10})[0]);
+
+  sparse.Clear(kColorWhite);
+  ASSERT_EQ(sparse.GetResidentTileCount(), 0u);
+  ASSERT_EQ(sparse.AverageColor(), kColorWhite);
+  ASSERT_TRUE(sparse.IsOpaque());
+}
+
+// Contrast, then GaussianBlur, then Saturation, then Sobel.
+static OpChain CreateTestChain() {
+  OpChain chain;
+  chain.AddPointOp([](Texture& texture) { texture.Contrast(0.3f); })
+      .AddNeighborhoodOp(3u,
+                         [](const Texture& src, Texture& dst) {
+                           return dst.GaussianBlur(src, 3u, 2.0f);
+                         })
+      .AddPointOp([](Texture& texture) { texture.Saturation(0.5f); })
+      .AddNeighborhoodOp(1u, [](const Texture& src, Texture& dst) {
+        return dst.Sobel(src, Component::kGreen, Component::kBlue);
+      });
+  return chain;
+}
+
+static void CopyRows(const Texture& src,
+                     uint32_t src_row,
+                     Texture& dst,
+                     uint32_t dst_row,
+                     uint32_t rows) {
+  for (auto comp : kComponents) {
+    ::memcpy(dst.GetAllocationMutable(comp, {0u, dst_row}),
+             src.GetAllocation(comp, {0u, src_row}), src.GetSize().x * rows);
+  }
+}
+
+TEST_F(MerleTest, StreamingMatchesWholeTexture) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  const auto chain = CreateTestChain();
+  ASSERT_EQ(chain.GetHalo(), 4u);
+  auto expected = image->Clone();
+  ASSERT_TRUE(chain.Run(expected));
+
+  for (uint32_t strip_height : {1u, 7u, 64u, 100000u}) {
+    StreamingExecutor executor(image->GetSize(), strip_height);
+    Texture streamed;
+    ASSERT_TRUE(streamed.Resize(image->GetSize()));
+    uint32_t next_row = 0u;
+    ASSERT_TRUE(executor.Run(
+        chain,
+        [&](uint32_t y, Texture& rows) {
+          CopyRows(*image, y, rows, 0u, rows.GetSize().y);
+          return true;
+        },
+        [&](uint32_t y, const Texture& rows) {
+          if (y != next_row || rows.GetSize().y > strip_height) {
+            return false;
+          }
+          CopyRows(rows, 0u, streamed, y, rows.GetSize().y);
+          next_row += rows.GetSize().y;
+          return true;
+        }));
+    ASSERT_EQ(next_row, image->GetSize().y);
+    ASSERT_TRUE(TexturesEqual(streamed, expected));
+  }
+}
+
+TEST_F(MerleTest, BandsMatchWholeTexture) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  const auto chain = CreateTestChain();
+  auto expected = image->Clone();
+  ASSERT_TRUE(chain.Run(expected));
+
+  Texture banded;
+  ASSERT_TRUE(banded.Resize(image->GetSize()));
+  ASSERT_FALSE(BandExecutor().Run(chain, banded, banded));
+  // From bands as short as the halo allows to a single band.
+  for (size_t cache_size : {0u, 64u << 10u, 1u << 30u}) {
+    for (uint32_t thread_count : {1u, 3u}) {
+      BandExecutor executor(cache_size, thread_count);
+      banded.Clear(kColorTransparentBlack);
+      ASSERT_TRUE(executor.Run(chain, *image, banded));
+      ASSERT_TRUE(TexturesEqual(banded, expected));
+    }
+  }
+  ASSERT_EQ(BandExecutor(0u).GetBandHeight(chain, image->GetSize().x),
+            chain.GetHalo());
+}
+
+TEST_F(MerleTest, InPlaceConvolutionMatchesOutOfPlace) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  const std::vector<float> kernels[] = {
+      Texture::CreateBoxKernel(1u),
+      Texture::CreateBoxKernel(5u),
+      Texture::CreateGaussianKernel(3u, 2.0f),
+  };
+  // Down to textures the kernel doesn't fit in.
+  for (auto size : {image->GetSize(), USize{97u, 13u}, USize{40u, 3u}}) {
+    Texture src;
+    ASSERT_TRUE(src.Resize(size));
+    src.Replace(*image, {});
+    for (const auto& kernel : kernels) {
+      for (auto space : {LightSpace::kSRGB, LightSpace::kLinear}) {
+        auto expected = src.Clone();
+        ASSERT_TRUE(expected.ConvolutionNxN(src, kernel, space));
+        auto in_place = src.Clone();
+        in_place.ConvolutionNxN(kernel, space);
+        ASSERT_TRUE(TexturesEqual(in_place, expected));
+      }
+    }
+  }
+}
+
+TEST_F(MerleTest, BatchMatchesImageByImage) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  const UPoint image_size = {image->GetSize().x, 48u};
+  const uint32_t image_count = image->GetSize().y / image_size.y;
+  TextureBatch src;
+  TextureBatch dst;
+  ASSERT_TRUE(src.Resize(image_size, image_count));
+  ASSERT_TRUE(dst.Resize(image_size, image_count));
+  for (uint32_t i = 0; i < image_count; i++) {
+    const auto rows = image->CloneRows(i * image_size.y, image_size.y);
+    ASSERT_TRUE(src.SetImage(i, rows));
+    ASSERT_TRUE(dst.SetImage(i, rows));
+  }
+  ASSERT_FALSE(src.SetImage(image_count, *image));
+
+  dst.GaussianBlur(src, 3u, 2.0f);
+  for (uint32_t i = 0; i < image_count; i++) {
+    const auto src_image = src.GetImage(i);
+    auto expected = src_image.Clone();
+    ASSERT_TRUE(expected.GaussianBlur(src_image, 3u, 2.0f));
+    ASSERT_TRUE(TexturesEqual(dst.GetImage(i), expected));
+  }
+
+  dst.Invert();
+  dst.Contrast(1.5f);
+  dst.Saturation(-0.5f);
+  dst.Brightness(0.1f);
+  dst.Exposure(0.5f);
+  dst.Grayscale();
+  for (uint32_t i = 0; i < image_count; i++) {
+    auto expected = src.GetImage(i);
+    ASSERT_TRUE(expected.GaussianBlur(src.GetImage(i), 3u, 2.0f));
+    expected.Invert();
+    expected.Contrast(1.5f);
+    expected.Saturation(-0.5f);
+    expected.Brightness(0.1f);
+    expected.Exposure(0.5f);
+    expected.Grayscale();
+    ASSERT_TRUE(TexturesEqual(dst.GetImage(i), expected));
+  }
+
+  for (uint32_t i = 0; i < image_count; i++) {
+    ASSERT_TRUE(dst.SetImage(i, src.GetImage(i)));
+  }
+  dst.Hue(Radians{1.0f});
+  dst.Sepia();
+  dst.RGBALevels(0.9f, 0.8f, 0.7f, 0.6f);
+  dst.Opacity(0.5f);
+  ASSERT_TRUE(dst.Sobel(src, Component::kGreen, Component::kBlue));
+  dst.LuminanceThreshold(0.3f);
+  for (uint32_t i = 0; i < image_count; i++) {
+    auto expected = src.GetImage(i);
+    expected.Hue(Radians{1.0f});
+    expected.Sepia();
+    expected.RGBALevels(0.9f, 0.8f, 0.7f, 0.6f);
+    expected.Opacity(0.5f);
+    ASSERT_TRUE(expected.Sobel(src.GetImage(i), Component::kGreen,
+                               Component::kBlue));
+    expected.LuminanceThreshold(0.3f);
+    ASSERT_TRUE(TexturesEqual(dst.GetImage(i), expected));
+  }
+
+  // Images share the pixels of the batch till they are written to.
+  auto first = src.GetImage(0u);
+  ASSERT_EQ(first.GetAllocation(), src.GetTexture().GetAllocation());
+  first.Invert();
+  ASSERT_TRUE(TexturesEqual(src.GetImage(0u),
+                            image->CloneRows(0u, image_size.y)));
+}
+
+TEST_F(MerleTest, FormattedTexturesRoundTrip) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  image->Opacity(0.75f);
+  Texture round_trip;
+  ASSERT_TRUE(round_trip.Resize(image->GetSize()));
+  for (auto format : {kPixelFormatRGBA8, kPixelFormatRGBA16,
+                      kPixelFormatRGBA16F, kPixelFormatRGBA32F}) {
+    FormattedTexture formatted(format);
+    ASSERT_TRUE(formatted.Resize(image->GetSize()));
+    ASSERT_TRUE(formatted.CopyFromTexture(*image));
+    // Through another element type and back.
+    FormattedTexture converted(kPixelFormatRGBA32F);
+    ASSERT_TRUE(converted.Resize(image->GetSize()));
+    ASSERT_TRUE(converted.Convert(formatted));
+    ASSERT_TRUE(formatted.Convert(converted));
+    round_trip.Clear(kColorTransparentBlack);
+    ASSERT_TRUE(formatted.CopyToTexture(round_trip));
+    ASSERT_TRUE(TexturesEqual(round_trip, *image));
+    ASSERT_FALSE(formatted.CopyFromTexture(*image, Component::kGreen));
+  }
+
+  FormattedTexture mask(kPixelFormatA8);
+  ASSERT_TRUE(mask.Resize(image->GetSize()));
+  ASSERT_EQ(mask.GetBytesPerPixel() * 4u, image->GetBytesPerPixel());
+  ASSERT_TRUE(mask.CopyFromTexture(*image, Component::kBlue));
+  ASSERT_EQ(::memcmp(mask.GetPlane(0u), image->GetBlue(),
+                     image->GetPixelCount()),
+            0);
+}
+
+TEST_F(MerleTest, FormattedFiltersMatchTexture) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  auto expected = image->Clone();
+  ASSERT_TRUE(expected.GaussianBlur(*image, 3u, 2.0f));
+  Texture blurred;
+  ASSERT_TRUE(blurred.Resize(image->GetSize()));
+  for (auto format : {kPixelFormatRGBA8, kPixelFormatRGBA16,
+                      kPixelFormatRGBA16F, kPixelFormatRGBA32F}) {
+    FormattedTexture src(format);
+    FormattedTexture dst(format);
+    ASSERT_TRUE(src.Resize(image->GetSize()));
+    ASSERT_TRUE(dst.Resize(image->GetSize()));
+    ASSERT_TRUE(src.CopyFromTexture(*image));
+    ASSERT_TRUE(dst.CopyFromTexture(*image));
+    ASSERT_TRUE(dst.GaussianBlur(src, 3u, 2.0f));
+    ASSERT_TRUE(dst.CopyToTexture(blurred));
+    // Textures truncate the sums where formatted textures round them.
+    ASSERT_TRUE(TexturesNear(blurred, expected, 1));
+  }
+
+  auto edges = image->Clone();
+  ASSERT_TRUE(edges.Sobel(*image, Component::kGreen, Component::kBlue));
+  FormattedTexture mask(kPixelFormatA8);
+  ASSERT_TRUE(mask.Resize(image->GetSize()));
+  ASSERT_TRUE(mask.CopyFromTexture(*image, Component::kBlue));
+  ASSERT_TRUE(mask.Sobel(*image, Component::kGreen));
+  ASSERT_EQ(::memcmp(mask.GetPlane(0u), edges.GetBlue(),
+                     image->GetPixelCount()),
+            0);
+  FormattedTexture float_mask(kPixelFormatR32F);
+  ASSERT_TRUE(float_mask.Resize(image->GetSize()));
+  ASSERT_FALSE(float_mask.Sobel(*image, Component::kGreen));
+}
+
+TEST_F(MerleTest, FloatPipelineDoesNotClip) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  FormattedTexture hdr(kPixelFormatRGBA32F);
+  ASSERT_TRUE(hdr.Resize(image->GetSize()));
+  ASSERT_TRUE(hdr.CopyFromTexture(*image));
+  hdr.Exposure(3.0f);
+  Matrix halve;
+  halve.e[0][0] = halve.e[1][1] = halve.e[2][2] = 0.5f;
+  ASSERT_TRUE(hdr.ColorMatrix(halve));
+  hdr.Exposure(-2.0f);
+  Texture result;
+  ASSERT_TRUE(result.Resize(image->GetSize()));
+  ASSERT_TRUE(hdr.CopyToTexture(result));
+  ASSERT_TRUE(TexturesEqual(result, *image));
+  // Clamping is the same as quantizing.
+  result.Clear(kColorTransparentBlack);
+  ASSERT_TRUE(hdr.ToneMap(result, ToneMapOperator::kClamp));
+  ASSERT_TRUE(TexturesEqual(result, *image));
+}
+
+TEST_F(MerleTest, ToneMapOperators) {
+  Texture white;
+  ASSERT_TRUE(white.Resize({67u, 29u}));
+  white.Clear(kColorWhite);
+  FormattedTexture hdr(
+      PixelFormat{.element_type = ElementType::kF16, .channel_count = 3u});
+  ASSERT_TRUE(hdr.Resize(white.GetSize()));
+  ASSERT_TRUE(hdr.CopyFromTexture(white));
+  ASSERT_NEAR(hdr.AverageLogLuminance(), 1.0f, 1e-3f);
+  ASSERT_NEAR(hdr.GetAutoExposure(0.25f), -2.0f, 1e-2f);
+
+  Texture result;
+  ASSERT_TRUE(result.Resize(white.GetSize()));
+  result.Clear(kColorTransparentBlack);
+  ASSERT_TRUE(hdr.ToneMap(result, ToneMapOperator::kReinhard));
+  // 1 / (1 + 1) and made opaque.
+  ASSERT_EQ(result.GetRed()[0], 128u);
+  ASSERT_EQ(result.GetBlue()[result.GetPixelCount() - 1u], 128u);
+  ASSERT_EQ(result.GetAlpha()[0], 255u);
+  ASSERT_TRUE(hdr.ToneMap(result, ToneMapOperator::kReinhard, 1.0f));
+  // 2 / (1 + 2)
+  ASSERT_EQ(result.GetGreen()[0], 170u);
+  ASSERT_TRUE(hdr.ToneMap(result, ToneMapOperator::kACES));
+  ASSERT_EQ(result.GetRed()[0], 172u);
+
+  FormattedTexture mask(kPixelFormatA8);
+  ASSERT_TRUE(mask.Resize(white.GetSize()));
+  ASSERT_FALSE(mask.ToneMap(result, ToneMapOperator::kACES));
+  ASSERT_EQ(mask.AverageLogLuminance(), 0.0f);
+}
+
+TEST_F(MerleTest, RGB565RoundTrips) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  RGB565Texture rgb565;
+  ASSERT_TRUE(rgb565.Resize(image->GetSize()));
+  ASSERT_TRUE(rgb565.CopyFromTexture(*image));
+  Texture expanded;
+  ASSERT_TRUE(expanded.Resize(image->GetSize()));
+  ASSERT_TRUE(rgb565.CopyToTexture(expanded));
+  for (size_t i = 0; i < image->GetPixelCount(); i++) {
+    ASSERT_LE(std::abs(expanded.GetRed()[i] - image->GetRed()[i]), 4);
+    ASSERT_LE(std::abs(expanded.GetGreen()[i] - image->GetGreen()[i]), 2);
+    ASSERT_LE(std::abs(expanded.GetBlue()[i] - image->GetBlue()[i]), 4);
+    ASSERT_EQ(expanded.GetAlpha()[i], 255u);
+  }
+  // Expanded pixels pack back to themselves.
+  Texture round_trip;
+  ASSERT_TRUE(round_trip.Resize(image->GetSize()));
+  ASSERT_TRUE(rgb565.CopyFromTexture(expanded));
+  ASSERT_TRUE(rgb565.CopyToTexture(round_trip));
+  ASSERT_TRUE(TexturesEqual(round_trip, expanded));
+
+  std::vector<uint8_t> rgb332(image->GetPixelCount());
+  image->Clear(kColorAquaMarine);
+  image->CopyToRGB332(rgb332.data());
+  // 127 / 255 * 7 and 212 / 255 * 3 round down to 3 and 2.
+  ASSERT_EQ(rgb332[0], (3u << 5) | (7u << 2) | 2u);
+}
+
+TEST_F(MerleTest, RGB565DitherKeepsAverage) {
+  Texture gray;
+  ASSERT_TRUE(gray.Resize({64u, 64u}));
+  gray.Clear({100, 100, 100, 255});
+  RGB565Texture rgb565;
+  ASSERT_TRUE(rgb565.Resize(gray.GetSize()));
+  Texture expanded;
+  ASSERT_TRUE(expanded.Resize(gray.GetSize()));
+  for (auto dither : {false, true}) {
+    ASSERT_TRUE(rgb565.CopyFromTexture(gray, dither));
+    ASSERT_TRUE(rgb565.CopyToTexture(expanded));
+    float sum = 0.0f;
+    for (size_t i = 0; i < expanded.GetPixelCount(); i++) {
+      sum += expanded.GetRed()[i];
+    }
+    const auto average = sum / expanded.GetPixelCount();
+    // Without dithering, every pixel is the nearest 5-bit level.
+    ASSERT_NEAR(average, dither ? 100.0f : 99.0f, dither ? 1.0f : 0.0f);
+  }
+}
+
+TEST_F(MerleTest, SRGBRoundTrips) {
+  // Every 8-bit value in each color component.
+  Texture ramp;
+  ASSERT_TRUE(ramp.Resize({256u, 3u}));
+  for (uint32_t x = 0; x < 256u; x++) {
+    for (uint32_t y = 0; y < 3u; y++) {
+      ramp.GetRedMutable({x, y})[0] = x;
+      ramp.GetGreenMutable({x, y})[0] = 255u - x;
+      ramp.GetBlueMutable({x, y})[0] = x;
+      ramp.GetAlphaMutable({x, y})[0] = x;
+    }
+  }
+  Texture round_trip;
+  ASSERT_TRUE(round_trip.Resize(ramp.GetSize()));
+  for (auto format : {kPixelFormatRGBA16, kPixelFormatRGBA16F}) {
+    FormattedTexture linear(format);
+    ASSERT_TRUE(linear.Resize(ramp.GetSize()));
+    ASSERT_TRUE(linear.DecodeFromTexture(ramp));
+    round_trip.Clear(kColorTransparentBlack);
+    ASSERT_TRUE(linear.EncodeToTexture(round_trip));
+    ASSERT_TRUE(TexturesEqual(round_trip, ramp));
+  }
+
+  FormattedTexture linear(kPixelFormatRGBA32F);
+  ASSERT_TRUE(linear.Resize(ramp.GetSize()));
+  ASSERT_TRUE(linear.DecodeFromTexture(ramp));
+  for (uint32_t x = 0; x < 256u; x++) {
+    const float srgb = x / 255.0f;
+    const float expected = srgb <= 0.04045f
+                               ? srgb / 12.92f
+                               : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+    ASSERT_NEAR(linear.GetPlane<float>(0u)[x], expected, 1e-6f);
+    // Alpha is not decoded.
+    ASSERT_NEAR(linear.GetPlane<float>(3u)[x], srgb, 1e-6f);
+  }
+}
+
+TEST_F(MerleTest, LinearLightFiltersMixInLinearLight) {
+  Texture black;
+  Texture white;
+  Texture mixed;
+  for (auto texture : {&black, &white, &mixed}) {
+    ASSERT_TRUE(texture->Resize({16u, 16u}));
+  }
+  black.Clear(kColorBlack);
+  white.Clear(kColorWhite);
+  ASSERT_TRUE(mixed.FadeTransition(black, white, 0.5f));
+  ASSERT_EQ(mixed.GetRed()[0], 127u);
+  ASSERT_TRUE(mixed.FadeTransition(black, white, 0.5f, LightSpace::kLinear));
+  // Half as much light as white.
+  ASSERT_EQ(mixed.GetRed()[0], 188u);
+  ASSERT_EQ(mixed.GetAlpha()[0], 255u);
+
+  mixed.Clear({188, 188, 188, 128});
+  mixed.PremultiplyAlpha(LightSpace::kLinear);
+  ASSERT_EQ(mixed.GetGreen()[0], 138u);
+  ASSERT_EQ(mixed.GetAlpha()[0], 128u);
+
+  // The same as blurring decoded components.
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  auto blurred = image->Clone();
+  ASSERT_TRUE(blurred.GaussianBlur(*image, 3u, 2.0f, LightSpace::kLinear));
+  FormattedTexture src(kPixelFormatRGBA32F);
+  FormattedTexture dst(kPixelFormatRGBA32F);
+  ASSERT_TRUE(src.Resize(image->GetSize()));
+  ASSERT_TRUE(dst.Resize(image->GetSize()));
+  ASSERT_TRUE(src.DecodeFromTexture(*image));
+  ASSERT_TRUE(dst.DecodeFromTexture(*image));
+  ASSERT_TRUE(dst.GaussianBlur(src, 3u, 2.0f));
+  Texture expected;
+  ASSERT_TRUE(expected.Resize(image->GetSize()));
+  ASSERT_TRUE(dst.EncodeToTexture(expected));
+  ASSERT_TRUE(TexturesEqual(blurred, expected));
+}
+
+TEST_F(MerleTest, ResampleFilters) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  const auto size = image->GetSize();
+  Texture resampled;
+  ASSERT_TRUE(resampled.Resize(size));
+  for (auto filter :
+       {Texture::ResampleFilter::kBilinear, Texture::ResampleFilter::kBicubic,
+        Texture::ResampleFilter::kLanczos3}) {
+    ASSERT_TRUE(image->Resample(resampled, filter));
+    ASSERT_TRUE(TexturesEqual(resampled, *image));
+  }
+  ASSERT_FALSE(image->Resample(*image, Texture::ResampleFilter::kBilinear));
+
+  // Halving averages each 2x2 block.
+  Texture even;
+  ASSERT_TRUE(even.Resize({size.x & ~1u, size.y & ~1u}));
+  even.Replace(*image, {});
+  ASSERT_TRUE(resampled.Resize({size.x / 2u, size.y / 2u}));
+  ASSERT_TRUE(even.Resample(resampled, Texture::ResampleFilter::kArea));
+  Texture expected;
+  ASSERT_TRUE(expected.Resize(resampled.GetSize()));
+  for (auto comp : kComponents) {
+    for (uint32_t y = 0; y < expected.GetSize().y; y++) {
+      for (uint32_t x = 0; x < expected.GetSize().x; x++) {
+        const auto* top = even.GetAllocation(comp, {2u * x, 2u * y});
+        const auto* bottom = even.GetAllocation(comp, {2u * x, 2u * y + 1u});
+        const auto sum = top[0] + top[1] + bottom[0] + bottom[1];
+        expected.GetAllocationMutable(comp, {x, y})[0] = (sum + 2) / 4;
+      }
+    }
+  }
+  ASSERT_TRUE(TexturesEqual(resampled, expected));
+
+  // Every filter keeps a flat color flat, up or down by any factor.
+  Texture flat;
+  ASSERT_TRUE(flat.Resize({40u, 30u}));
+  flat.Clear({10, 120, 200, 255});
+  for (auto filter :
+       {Texture::ResampleFilter::kBilinear, Texture::ResampleFilter::kBicubic,
+        Texture::ResampleFilter::kLanczos3, Texture::ResampleFilter::kArea}) {
+    for (auto dst_size : {UPoint{15u, 7u}, UPoint{97u, 61u}}) {
+      ASSERT_TRUE(resampled.Resize(dst_size));
+      ASSERT_TRUE(flat.Resample(resampled, filter));
+      ASSERT_TRUE(expected.Resize(dst_size));
+      expected.Clear({10, 120, 200, 255});
+      ASSERT_TRUE(TexturesEqual(resampled, expected));
+    }
+  }
+}
+
+TEST_F(MerleTest, ResampleAlphaWeighted) {
+  // Opaque red on the left half, transparent green on the right.
+  Texture texture;
+  ASSERT_TRUE(texture.Resize({4u, 4u}));
+  texture.Clear({0, 255, 0, 0});
+  for (uint32_t y = 0; y < 4u; y++) {
+    for (uint32_t x = 0; x < 2u; x++) {
+      texture.GetRedMutable({x, y})[0] = 255u;
+      texture.GetGreenMutable({x, y})[0] = 0u;
+      texture.GetAlphaMutable({x, y})[0] = 255u;
+    }
+  }
+  Texture pixel;
+  ASSERT_TRUE(pixel.Resize({1u, 1u}));
+  // Through the box path and the separable path.
+  for (auto filter :
+       {Texture::ResampleFilter::kArea, Texture::ResampleFilter::kBilinear}) {
+    ASSERT_TRUE(texture.Resample(pixel, filter));
+    ASSERT_EQ(pixel.GetRed()[0], 128u);
+    ASSERT_EQ(pixel.GetGreen()[0], 128u);
+    ASSERT_EQ(pixel.GetAlpha()[0], 128u);
+    ASSERT_TRUE(texture.Resample(pixel, filter, true));
+    ASSERT_EQ(pixel.GetRed()[0], 255u);
+    ASSERT_EQ(pixel.GetGreen()[0], 0u);
+    ASSERT_EQ(pixel.GetAlpha()[0], 128u);
+  }
+}
+
+TEST_F(MerleTest, PyramidMatchesRepeatedHalving) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  // Odd sizes and power of two sizes. Both take two passes.
+  Texture cropped;
+  ASSERT_TRUE(cropped.Resize({512u, 256u}));
+  cropped.Replace(*image, {});
+  for (const auto* texture : {&image.value(), &cropped}) {
+    auto pyramid = texture->BuildPyramid(64u);
+    ASSERT_TRUE(pyramid.has_value());
+    const auto size = texture->GetSize();
+    // One level per bit of the larger side.
+    ASSERT_EQ(pyramid->size(),
+              static_cast<size_t>(std::bit_width(std::max(size.x, size.y))));
+    ASSERT_EQ(pyramid->back().GetSize(), UPoint(1u, 1u));
+    ASSERT_TRUE(TexturesEqual(pyramid->front(), *texture));
+    for (size_t i = 1; i < pyramid->size(); i++) {
+      // Halving drops the odd row and column.
+      const auto& above = (*pyramid)[i - 1];
+      const auto above_size = above.GetSize();
+      Texture even;
+      ASSERT_TRUE(even.Resize({std::max(above_size.x & ~1u, 1u),
+                               std::max(above_size.y & ~1u, 1u)}));
+      even.Replace(above, {});
+      Texture expected;
+      ASSERT_TRUE(expected.Resize((*pyramid)[i].GetSize()));
+      ASSERT_TRUE(even.Resample(expected, Texture::ResampleFilter::kArea));
+      ASSERT_TRUE(TexturesEqual((*pyramid)[i], expected));
+    }
+  }
+  auto pyramid = cropped.BuildPyramid(3u);
+  ASSERT_TRUE(pyramid.has_value());
+  ASSERT_EQ(pyramid->size(), 3u);
+  ASSERT_EQ((*pyramid)[2].GetSize(), UPoint(128u, 64u));
+  ASSERT_FALSE(Texture{}.BuildPyramid(3u).has_value());
+}
+
+TEST_F(MerleTest, WarpMapsPixels) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  const auto size = image->GetSize();
+  Texture warped;
+  ASSERT_TRUE(warped.Resize(size));
+  ASSERT_TRUE(warped.Warp(*image, Transform()));
+  ASSERT_TRUE(TexturesEqual(warped, *image));
+  ASSERT_FALSE(warped.Warp(warped, Transform()));
+  ASSERT_FALSE(warped.Warp(*image, Transform::MakeScale(0.0f, 1.0f)));
+
+  // Pixels shifted in from outside the source keep their values.
+  warped.Clear(kColorBlack);
+  ASSERT_TRUE(warped.Warp(*image, Transform::MakeTranslation(3.0f, 2.0f)));
+  Texture expected;
+  ASSERT_TRUE(expected.Resize(size));
+  expected.Clear(kColorBlack);
+  expected.Replace(*image, {3, 2});
+  ASSERT_TRUE(TexturesEqual(warped, expected));
+
+  // A quarter turn clockwise.
+  ASSERT_TRUE(warped.Resize({size.y, size.x}));
+  ASSERT_TRUE(expected.Resize({size.y, size.x}));
+  ASSERT_TRUE(warped.Warp(
+      *image, Transform::MakeTranslation(size.y, 0.0f) *
+                  Transform::MakeRotation(Degrees(90.0f))));
+  for (auto comp : kComponents) {
+    for (uint32_t y = 0; y < size.x; y++) {
+      for (uint32_t x = 0; x < size.y; x++) {
+        expected.GetAllocationMutable(comp, {x, y})[0] =
+            image->GetAllocation(comp, {y, size.y - 1u - x})[0];
+      }
+    }
+  }
+  ASSERT_TRUE(TexturesEqual(warped, expected));
+
+  // A perspective warp of a square into a trapezoid only covers the
+  // trapezoid.
+  Texture square;
+  ASSERT_TRUE(square.Resize({64u, 64u}));
+  square.Clear(kColorRed);
+  const auto transform = Transform::MakeQuadToQuad(
+      {PointF{0.0f, 0.0f}, {64.0f, 0.0f}, {64.0f, 64.0f}, {0.0f, 64.0f}},
+      {PointF{24.0f, 8.0f}, {40.0f, 8.0f}, {56.0f, 56.0f}, {8.0f, 56.0f}});
+  ASSERT_TRUE(transform.has_value());
+  ASSERT_EQ(transform->Map({64.0f, 0.0f}).x, 40.0f);
+  warped.Clear(kColorTransparentBlack);
+  ASSERT_TRUE(warped.Warp(square, *transform));
+  ASSERT_EQ(warped.GetRed({32u, 32u})[0], 255u);
+  ASSERT_EQ(warped.GetAlpha({32u, 54u})[0], 255u);
+  ASSERT_EQ(warped.GetAlpha({12u, 12u})[0], 0u);
+  ASSERT_EQ(warped.GetAlpha({52u, 12u})[0], 0u);
+  ASSERT_EQ(warped.GetAlpha({32u, 60u})[0], 0u);
+}
+
+TEST_F(MerleTest, RemapMatchesWarp) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  const auto size = image->GetSize();
+  Texture remapped;
+  ASSERT_TRUE(remapped.Resize(size));
+  RemapTable table;
+  ASSERT_TRUE(table.Build(size, size, Transform()));
+  ASSERT_TRUE(remapped.Remap(*image, table));
+  ASSERT_TRUE(TexturesEqual(remapped, *image));
+  ASSERT_FALSE(remapped.Remap(remapped, table));
+  ASSERT_FALSE(table.Build(size, {1u << 16, 1u}, Transform()));
+
+  // A mirror from a function.
+  ASSERT_TRUE(table.Build(size, size, [&](PointF point) {
+    return PointF{size.x - point.x, point.y};
+  }));
+  ASSERT_TRUE(remapped.Remap(*image, table));
+  for (uint32_t x = 0; x < size.x; x++) {
+    ASSERT_EQ(remapped.GetGreen({x, 7u})[0],
+              image->GetGreen({size.x - 1u - x, 7u})[0]);
+  }
+
+  // Weights are quantized so the result is off by at most one.
+  const auto center = Transform::MakeTranslation(size.x / 2.0f, size.y / 2.0f);
+  const auto rotation =
+      center * Transform::MakeRotation(Degrees(7.0f)) * *center.Invert();
+  ASSERT_TRUE(table.Build(size, size, rotation));
+  Texture warped;
+  ASSERT_TRUE(warped.Resize(size));
+  warped.Clear(kColorTransparentBlack);
+  remapped.Clear(kColorTransparentBlack);
+  ASSERT_TRUE(warped.Warp(*image, rotation));
+  ASSERT_TRUE(remapped.Remap(*image, table));
+  ASSERT_TRUE(TexturesNear(remapped, warped, 1));
+  ASSERT_EQ(remapped.GetAlpha()[0], 0u);
+}
+
+TEST_F(MerleTest, RotationsAndFlips) {
+  auto image = Texture::CreateFromFile(NS_ASSETS_LOCATION "boston.jpg");
+  ASSERT_TRUE(image.has_value());
+  // Make the components differ so mixed up planes show.
+  image->Opacity(0.5f);
+  const auto size = image->GetSize();
+  const UPoint turned_size = {size.y, size.x};
+  Texture turned;
+  Texture expected;
+  ASSERT_TRUE(turned.Resize(turned_size));
+  ASSERT_TRUE(expected.Resize(turned_size));
+
+  // Each of the quarter turns and the transpose against the same warp.
+  const auto turn = [&](Texture& dst, Degrees degrees, float x, float y) {
+    return dst.Warp(*image, Transform::MakeTranslation(x, y) *
+                                Transform::MakeRotation(degrees));
+  };
+  ASSERT_TRUE(turned.Rotate90(*image));
+  ASSERT_TRUE(turn(expected, Degrees(90.0f), size.y, 0.0f));
+  ASSERT_TRUE(TexturesEqual(turned, expected));
+  ASSERT_TRUE(turned.Rotate270(*image));
+  ASSERT_TRUE(turn(expected, Degrees(-90.0f), 0.0f, size.x));
+  ASSERT_TRUE(TexturesEqual(turned, expected));
+  ASSERT_TRUE(turned.Transpose(*image));
+  ASSERT_TRUE(expected.Warp(*image, Transform(0.0f, 1.0f, 0.0f,  //
+                                              1.0f, 0.0f, 0.0f,  //
+                                              0.0f, 0.0f, 1.0f)));
+  ASSERT_TRUE(TexturesEqual(turned, expected));
+  ASSERT_FALSE(turned.Rotate180(*image));
+
+  ASSERT_TRUE(turned.Resize(size));
+  ASSERT_TRUE(expected.Resize(size));
+  ASSERT_TRUE(turned.Rotate180(*image));
+  ASSERT_TRUE(turn(expected, Degrees(180.0f), size.x, size.y));
+  ASSERT_TRUE(TexturesEqual(turned, expected));
+  ASSERT_TRUE(turned.Flip(*image, Texture::Direction::kHorizontal));
+  ASSERT_TRUE(expected.Warp(
+      *image, Transform::MakeTranslation(size.x, 0.0f) *
+                  Transform::MakeScale(-1.0f, 1.0f)));
+  ASSERT_TRUE(TexturesEqual(turned, expected));
+  ASSERT_TRUE(turned.Flip(*image, Texture::Direction::kVertical));
+  ASSERT_TRUE(expected.Warp(
+      *image, Transform::MakeTranslation(0.0f, size.y) *
+                  Transform::MakeScale(1.0f, -1.0f)));
+  ASSERT_TRUE(TexturesEqual(turned, expected));
+  ASSERT_FALSE(turned.Flip(turned, Texture::Direction::kVertical));
+}
+
+TEST_F(MerleTest, ReplaceClipsNegativeOffsets) {
+  Texture canvas;
+  ASSERT_TRUE(canvas.Resize({8u, 8u}));
+  canvas.Clear(kColorBlack);
+  Texture patch;
+  ASSERT_TRUE(patch.Resize({4u, 4u}));
+  for (uint32_t y = 0; y < 4u; y++) {
+    for (uint32_t x = 0; x < 4u; x++) {
+      patch.GetRedMutable({x, y})[0] = 10u * y + x;
+    }
+  }
+  canvas.Replace(patch, {-2, -1});
+  ASSERT_EQ(canvas.GetRed({0u, 0u})[0], 12u);
+  ASSERT_EQ(canvas.GetRed({1u, 2u})[0], 33u);
+  ASSERT_EQ(canvas.GetRed({2u, 0u})[0], 0u);
+  ASSERT_EQ(canvas.GetRed({0u, 3u})[0], 0u);
+  canvas.Replace(patch, {6, 7});
+  ASSERT_EQ(canvas.GetRed({7u, 7u})[0], 1u);
+}
+
+TEST_F(MerleTest, CompositeModes) {
+  // Premultiplied pixels of every mix of alphas.
+  Texture src;
+  Texture dst;
+  ASSERT_TRUE(src.Resize({64u, 64u}));
+  ASSERT_TRUE(dst.Resize({64u, 64u}));
+  for (uint32_t y = 0; y < 64u; y++) {
+    for (uint32_t x = 0; x < 64u; x++) {
+      const uint8_t src_alpha = x * 4u + 3u;
+      const uint8_t dst_alpha = y * 4u + 1u;
+      src.GetAlphaMutable({x, y})[0] = src_alpha;
+      dst.GetAlphaMutable({x, y})[0] = dst_alpha;
+      for (auto comp : {Component::kRed, Component::kGreen, Component::kBlue}) {
+        src.GetAllocationMutable(comp, {x, y})[0] = src_alpha * (x + y) / 126u;
+        dst.GetAllocationMutable(comp, {x, y})[0] = dst_alpha * (x % 7u) / 6u;
+      }
+    }
+  }
+  using Mode = Texture::CompositeMode;
+  // The fractions of the source and the destination that each mode keeps.
+  const auto get_factors = [](Mode mode, float sa, float da) {
+    switch (mode) {
+      case Mode::kClear:
+        return std::pair{0.0f, 0.0f};
+      case Mode::kSrc:
+        return std::pair{1.0f, 0.0f};
+      case Mode::kDst:
+        return std::pair{0.0f, 1.0f};
+      case Mode::kSrcOver:
+        return std::pair{1.0f, 1.0f - sa};
+      case Mode::kDstOver:
+        return std::pair{1.0f - da, 1.0f};
+      case Mode::kSrcIn:
+        return std::pair{da, 0.0f};
+      case Mode::kDstIn:
+        return std::pair{0.0f, sa};
+      case Mode::kSrcOut:
+        return std::pair{1.0f - da, 0.0f};
+      case Mode::kDstOut:
+        return std::pair{0.0f, 1.0f - sa};
+      case Mode::kSrcAtop:
+        return std::pair{da, 1.0f - sa};
+      case Mode::kDstAtop:
+        return std::pair{1.0f - da, sa};
+      case Mode::kXor:
+        return std::pair{1.0f - da, 1.0f - sa};
+      case Mode::kPlus:
+        return std::pair{1.0f, 1.0f};
+    }
+    return std::pair{0.0f, 0.0f};
+  };
+  for (int i = 0; i <= static_cast<int>(Mode::kPlus); i++) {
+    const auto mode = static_cast<Mode>(i);
+    auto result = dst.Clone();
+    ASSERT_TRUE(result.Composite(src, {}, mode, 1.0f,
+                                 AlphaType::kPremultiplied));
+    for (uint32_t y = 0; y < 64u; y++) {
+      for (uint32_t x = 0; x < 64u; x++) {
+        const auto [src_factor, dst_factor] =
+            get_factors(mode, src.GetAlpha({x, y})[0] / 255.0f,
+                        dst.GetAlpha({x, y})[0] / 255.0f);
+        for (auto comp : kComponents) {
+          const auto expected = std::min(
+              src.GetAllocation(comp, {x, y})[0] * src_factor +
+                  dst.GetAllocation(comp, {x, y})[0] * dst_factor,
+              255.0f);
+          ASSERT_NEAR(result.GetAllocation(comp, {x, y})[0], expected, 1.0f);
+        }
+      }
+    }
+  }
+
+  // Straight alpha, clipped at the top left.
+  Texture canvas;
+  ASSERT_TRUE(canvas.Resize({4u, 4u}));
+  canvas.Clear(kColorBlue);
+  Texture red;
+  ASSERT_TRUE(red.Resize({2u, 2u}));
+  red.Clear({255, 0, 0, 128});
+  ASSERT_TRUE(canvas.Composite(red, {-1, -1}, Mode::kSrcOver));
+  ASSERT_EQ(canvas.GetRed()[0], 128u);
+  ASSERT_EQ(canvas.GetBlue()[0], 127u);
+  ASSERT_EQ(canvas.GetAlpha()[0], 255u);
+  ASSERT_EQ(canvas.GetRed({1u, 0u})[0], 0u);
+  ASSERT_TRUE(canvas.Composite(red, {3, 3}, Mode::kSrcOver, 0.0f));
+  ASSERT_EQ(canvas.GetBlue({3u, 3u})[0], 255u);
+  ASSERT_TRUE(canvas.Composite(red, {3, 3}, Mode::kSrc));
+  ASSERT_EQ(canvas.GetRed({3u, 3u})[0], 255u);
+  ASSERT_EQ(canvas.GetAlpha({3u, 3u})[0], 128u);
+  ASSERT_FALSE(canvas.Composite(canvas, {}, Mode::kSrcOver));
+}
+
+TEST_F(MerleTest, BlendModes) {
+  Texture bottom;
+  Texture top;
+  ASSERT_TRUE(bottom.Resize({16u, 16u}));
+  ASSERT_TRUE(top.Resize({16u, 16u}));
+  bottom.Clear(Color(102u, 102u, 102u, 255u));
+  top.Clear(Color(204u, 204u, 204u, 255u));
+  using Mode = Texture::BlendMode;
+  // Opaque layers of 0.4 and 0.8 per the formulas of the spec.
+  const std::vector<std::pair<Mode, uint8_t>> expectations = {
+      {Mode::kNormal, 204u},     {Mode::kMultiply, 82u},
+      {Mode::kScreen, 224u},     {Mode::kOverlay, 163u},
+      {Mode::kDarken, 102u},     {Mode::kLighten, 204u},
+      {Mode::kColorDodge, 255u}, {Mode::kColorBurn, 64u},
+      {Mode::kHardLight, 194u},  {Mode::kSoftLight, 138u},
+      {Mode::kDifference, 102u}, {Mode::kExclusion, 143u},
+  };
+  for (const auto& [mode, expected] : expectations) {
+    Texture result;
+    ASSERT_TRUE(result.Blend(bottom, top, mode));
+    ASSERT_NEAR(result.GetRed({3u, 5u})[0], expected, 1);
+    ASSERT_NEAR(result.GetBlue({15u, 15u})[0], expected, 1);
+    ASSERT_EQ(result.GetAlpha({3u, 5u})[0], 255u);
+    // Half the opacity lands halfway to the bottom.
+    ASSERT_TRUE(result.Blend(bottom, top, mode, 0.5f));
+    ASSERT_NEAR(result.GetGreen({7u, 2u})[0], (102 + expected) / 2.0f, 1.0f);
+  }
+
+  // Nothing to blend with over a transparent bottom.
+  Texture transparent;
+  ASSERT_TRUE(transparent.Resize({16u, 16u}));
+  transparent.Clear(Color(10u, 20u, 30u, 0u));
+  top.Clear(Color(200u, 100u, 50u, 128u));
+  Texture result;
+  ASSERT_TRUE(result.Blend(transparent, top, Mode::kMultiply));
+  ASSERT_EQ(result.GetRed({1u, 1u})[0], 200u);
+  ASSERT_EQ(result.GetGreen({1u, 1u})[0], 100u);
+  ASSERT_EQ(result.GetBlue({1u, 1u})[0], 50u);
+  ASSERT_EQ(result.GetAlpha({1u, 1u})[0], 128u);
+
+  // Layers may be flattened in place, even onto a texture sharing planes.
+  ASSERT_TRUE(result.Blend(bottom, top, Mode::kOverlay));
+  auto canvas = bottom.Clone();
+  ASSERT_TRUE(canvas.Blend(canvas, top, Mode::kOverlay));
+  ASSERT_EQ(canvas.GetRed({9u, 9u})[0], result.GetRed({9u, 9u})[0]);
+  ASSERT_EQ(canvas.GetAlpha({9u, 9u})[0], result.GetAlpha({9u, 9u})[0]);
+  ASSERT_EQ(bottom.GetRed({9u, 9u})[0], 102u);
+
+  Texture small;
+  ASSERT_TRUE(small.Resize({8u, 16u}));
+  ASSERT_FALSE(result.Blend(small, top, Mode::kNormal));
+}
+
+TEST_F(MerleTest, BlitBatchMatchesBlend) {
+  // An atlas of two sprites with gradients of color and alpha.
+  std::array<Texture, 2u> sprites;
+  Texture atlas;
+  ASSERT_TRUE(atlas.Resize({64u, 32u}));
+  for (uint32_t i = 0; i < sprites.size(); i++) {
+    ASSERT_TRUE(sprites[i].Resize({32u, 32u}));
+    for (uint32_t y = 0; y < 32u; y++) {
+      for (uint32_t x = 0; x < 32u; x++) {
+        sprites[i].GetRedMutable({x, y})[0] = x * 8u;
+        sprites[i].GetGreenMutable({x, y})[0] = y * 8u;
+        sprites[i].GetBlueMutable({x, y})[0] = 255u * i;
+        sprites[i].GetAlphaMutable({x, y})[0] = (x + y) * 4u + 3u;
+      }
+    }
+    atlas.Replace(sprites[i], {static_cast<int32_t>(i) * 32, 0});
+  }
+  Texture canvas;
+  ASSERT_TRUE(canvas.Resize({300u, 200u}));
+  canvas.Clear(kColorCoral.WithAlpha(200u));
+  auto expected = canvas.Clone();
+
+  // Overlapping blits across tiles and the edges of the canvas, drawn one at
+  // a time as layers for the expected result.
+  BlitBatch batch;
+  Texture layer;
+  ASSERT_TRUE(layer.Resize(canvas.GetSize()));
+  for (int32_t i = 0; i < 40; i++) {
+    const auto sprite = static_cast<uint32_t>(i) % 2u;
+    const auto point = Point{(i * 37) % 330 - 20, (i * 23) % 230 - 20};
+    const auto opacity = 0.25f + (i % 4) * 0.25f;
+    const auto mode = static_cast<Texture::BlendMode>(i % 12);
+    batch.Add(Rect{static_cast<int32_t>(sprite) * 32, 0, 32, 32}, point,
+              opacity, mode);
+    layer.Clear(Color(0u, 0u, 0u, 0u));
+    layer.Replace(sprites[sprite], point);
+    ASSERT_TRUE(expected.Blend(expected, layer, mode, opacity));
+  }
+  ASSERT_EQ(batch.GetBlitCount(), 40u);
+  ASSERT_TRUE(batch.Draw(atlas, canvas));
+  for (uint32_t y = 0; y < 200u; y++) {
+    for (uint32_t x = 0; x < 300u; x++) {
+      for (auto comp : kComponents) {
+        ASSERT_NEAR(canvas.GetAllocation(comp, {x, y})[0],
+                    expected.GetAllocation(comp, {x, y})[0], 1);
+      }
+    }
+  }
+
+  // Regions are clipped to the atlas. Only the top right quarter of the atlas
+  // is in this one, which lands below the point.
+  batch.Clear();
+  batch.Add(Rect{48, -16, 32, 32}, {0, 0});
+  ASSERT_TRUE(batch.Draw(atlas, canvas));
+  Texture quarter;
+  ASSERT_TRUE(quarter.Resize({16u, 16u}));
+  quarter.Replace(sprites[1], {-16, 0});
+  layer.Clear(Color(0u, 0u, 0u, 0u));
+  layer.Replace(quarter, {0, 16});
+  ASSERT_TRUE(expected.Blend(expected, layer, Texture::BlendMode::kNormal));
+  for (uint32_t y = 0; y < 48u; y++) {
+    for (uint32_t x = 0; x < 48u; x++) {
+      ASSERT_NEAR(canvas.GetRed({x, y})[0], expected.GetRed({x, y})[0], 1);
+      ASSERT_NEAR(canvas.GetAlpha({x, y})[0], expected.GetAlpha({x, y})[0], 1);
+    }
+  }
+  ASSERT_FALSE(batch.Draw(atlas, atlas));
+}
+
+TEST_F(MerleTest, RasterizerFillsPixelCenters) {
+  const auto size = UPoint{96u, 80u};
+  Rasterizer rasterizer(size);
+  Texture texture;
+  ASSERT_TRUE(texture.Resize(size));
+  // Fill a shape and check that exactly the pixels whose centers are inside
+  // it were painted.
+  const auto check_shape = [&](auto&& fill, auto&& contains) {
+    texture.Clear(kColorBlack);
+    rasterizer.Clear();
+    fill();
+    ASSERT_TRUE(rasterizer.Draw(texture));
+    for (uint32_t y = 0; y < size.y; y++) {
+      for (uint32_t x = 0; x < size.x; x++) {
+        ASSERT_EQ(texture.GetRed({x, y})[0] == 255u,
+                  contains(x + 0.5f, y + 0.5f));
+      }
+    }
+  };
+  check_shape([&] { rasterizer.FillRect(Rect{-4, 10, 30, 20}, kColorRed); },
+              [](float x, float y) { return x < 26 && y > 10 && y < 30; });
+  check_shape(
+      [&] { rasterizer.FillCircle({40.3f, 50.6f}, 37.2f, kColorRed); },
+      [](float x, float y) {
+        return std::hypot(x - 40.3f, y - 50.6f) < 37.2f;
+      });
+  check_shape(
+      [&] { rasterizer.FillRoundRect(Rect{10, 5, 70, 50}, 12.3f, kColorRed); },
+      [](float x, float y) {
+        if (x < 10 || x >= 80 || y < 5 || y >= 55) {
+          return false;
+        }
+        const auto cx = std::clamp(x, 22.3f, 67.7f);
+        const auto cy = std::clamp(y, 17.3f, 42.7f);
+        return std::hypot(x - cx, y - cy) <= 12.3f;
+      });
+
+  // A five pointed star. The pentagon in the middle is wound around twice.
+  std::vector<PointF> star;
+  for (int i = 0; i < 5; i++) {
+    const auto angle = i * 4.0f * kPi / 5.0f - kPi / 2.0f;
+    star.push_back(
+        {48.1f + 35.0f * std::cos(angle), 40.2f + 35.0f * std::sin(angle)});
+  }
+  // Count the windings with a ray to the right of the point.
+  const auto get_winding = [&](float x, float y) {
+    int winding = 0;
+    for (size_t i = 0; i < star.size(); i++) {
+      const auto& a = star[i];
+      const auto& b = star[(i + 1u) % star.size()];
+      if ((a.y <= y) != (b.y <= y) &&
+          a.x + (y - a.y) / (b.y - a.y) * (b.x - a.x) > x) {
+        winding += b.y > a.y ? 1 : -1;
+      }
+    }
+    return winding;
+  };
+  check_shape(
+      [&] { rasterizer.FillPolygon(star, kColorRed, FillRule::kNonZero); },
+      [&](float x, float y) { return get_winding(x, y) != 0; });
+  check_shape(
+      [&] { rasterizer.FillPolygon(star, kColorRed, FillRule::kEvenOdd); },
+      [&](float x, float y) { return get_winding(x, y) % 2 != 0; });
+  ASSERT_EQ(texture.GetRed({48u, 40u})[0], 0u);
+
+  // Later shapes land on top and translucent ones are composited.
+  texture.Clear(kColorWhite);
+  rasterizer.Clear();
+  rasterizer.FillRect(Rect{0, 0, 20, 20}, kColorBlue);
+  rasterizer.FillRect(Rect{10, 0, 20, 20}, kColorRed.WithAlpha(128u));
+  ASSERT_TRUE(rasterizer.Draw(texture));
+  ASSERT_EQ(texture.GetBlue({5u, 5u})[0], 255u);
+  ASSERT_NEAR(texture.GetBlue({15u, 5u})[0], 127, 1);
+  ASSERT_NEAR(texture.GetRed({15u, 5u})[0], 128, 1);
+  ASSERT_EQ(texture.GetRed({25u, 5u})[0], 255u);
+  ASSERT_NEAR(texture.GetGreen({25u, 5u})[0], 127, 1);
+  ASSERT_EQ(texture.GetAlpha({25u, 5u})[0], 255u);
+
+  Texture small;
+  ASSERT_TRUE(small.Resize({8u, 8u}));
+  ASSERT_FALSE(rasterizer.Draw(small));
+}
+
+TEST_F(MerleTest, PathRasterizerCoverage) {
+  const auto size = UPoint{64u, 48u};
+  PathRasterizer rasterizer(size);
+  const auto get_coverage = [&](uint32_t x, uint32_t y) {
+    return static_cast<int>(rasterizer.GetMask()[y * size.x + x]);
+  };
+  const auto add_rect = [](Path& path, float left, float top, float right,
+                           float bottom) {
+    path.MoveTo({left, top});
+    path.LineTo({right, top});
+    path.LineTo({right, bottom});
+    path.LineTo({left, bottom});
+    path.Close();
+  };
+
+  // Partly covered pixels along the edges of a rectangle.
+  Path path;
+  add_rect(path, 10.25f, 5.5f, 30.75f, 20.0f);
+  rasterizer.Rasterize(path);
+  ASSERT_EQ(get_coverage(9u, 10u), 0);
+  ASSERT_NEAR(get_coverage(10u, 10u), 191, 1);
+  ASSERT_EQ(get_coverage(20u, 10u), 255);
+  ASSERT_NEAR(get_coverage(30u, 10u), 191, 1);
+  ASSERT_EQ(get_coverage(31u, 10u), 0);
+  ASSERT_NEAR(get_coverage(20u, 5u), 128, 1);
+  ASSERT_NEAR(get_coverage(10u, 5u), 96, 1);
+  ASSERT_EQ(get_coverage(20u, 20u), 0);
+
+  // A circle of cubics. The mask covers the area of the lines it was flattened
+  // into, which stray from the circle by no more than the tolerance. The
+  // rectangle is gone.
+  constexpr float kKappa = 0.5522848f;
+  const auto center = PointF{40.3f, 24.1f};
+  const auto radius = 18.0f;
+  const auto k = radius * kKappa;
+  path.Reset();
+  path.MoveTo({center.x + radius, center.y});
+  path.CubicTo({center.x + radius, center.y + k},
+               {center.x + k, center.y + radius},
+               {center.x, center.y + radius});
+  path.CubicTo({center.x - k, center.y + radius},
+               {center.x - radius, center.y + k},
+               {center.x - radius, center.y});
+  path.CubicTo({center.x - radius, center.y - k},
+               {center.x - k, center.y - radius},
+               {center.x, center.y - radius});
+  path.CubicTo({center.x + k, center.y - radius},
+               {center.x + radius, center.y - k},
+               {center.x + radius, center.y});
+  rasterizer.Rasterize(path);
+  float area = 0.0f;
+  for (uint32_t y = 0; y < size.y; y++) {
+    for (uint32_t x = 0; x < size.x; x++) {
+      area += get_coverage(x, y) / 255.0f;
+    }
+  }
+  float flattened_area = 0.0f;
+  for (const auto& segment : path.GetSegments()) {
+    flattened_area += (segment.from.x * segment.to.y -
+                       segment.to.x * segment.from.y) / 2.0f;
+  }
+  ASSERT_NEAR(area, flattened_area, 0.5f);
+  ASSERT_NEAR(flattened_area, kPi * radius * radius,
+              2.0f * kPi * radius * Path::kTolerance);
+  ASSERT_EQ(get_coverage(40u, 24u), 255);
+  ASSERT_EQ(get_coverage(20u, 10u), 0);
+
+  // Nested rectangles wound the same way, with the outer one hanging off the
+  // left of the mask.
+  path.Reset();
+  add_rect(path, -8.0f, 4.0f, 40.0f, 40.0f);
+  add_rect(path, 12.0f, 12.0f, 24.0f, 24.0f);
+  rasterizer.Rasterize(path, FillRule::kNonZero);
+  ASSERT_EQ(get_coverage(0u, 8u), 255);
+  ASSERT_EQ(get_coverage(16u, 16u), 255);
+  rasterizer.Rasterize(path, FillRule::kEvenOdd);
+  ASSERT_EQ(get_coverage(0u, 8u), 255);
+  ASSERT_EQ(get_coverage(16u, 16u), 0);
+  // Wound the other way, the inner one is a hole either way.
+  path.Reset();
+  add_rect(path, -8.0f, 4.0f, 40.0f, 40.0f);
+  path.MoveTo({12.0f, 12.0f});
+  path.LineTo({12.0f, 24.0f});
+  path.LineTo({24.0f, 24.0f});
+  path.LineTo({24.0f, 12.0f});
+  rasterizer.Rasterize(path, FillRule::kNonZero);
+  ASSERT_EQ(get_coverage(16u, 16u), 0);
+  ASSERT_EQ(get_coverage(30u, 16u), 255);
+
+  // Fill through the mask.
+  path.Reset();
+  add_rect(path, 0.0f, 0.0f, 32.5f, 16.0f);
+  rasterizer.Rasterize(path);
+  Texture texture;
+  ASSERT_TRUE(texture.Resize(size));
+  texture.Clear(kColorWhite);
+  ASSERT_TRUE(rasterizer.Fill(texture, kColorRed));
+  ASSERT_EQ(texture.GetRed({8u, 8u})[0], 255u);
+  ASSERT_EQ(texture.GetGreen({8u, 8u})[0], 0u);
+  ASSERT_NEAR(texture.GetGreen({32u, 8u})[0], 127, 1);
+  ASSERT_EQ(texture.GetGreen({40u, 8u})[0], 255u);
+  ASSERT_EQ(texture.GetAlpha({32u, 8u})[0], 255u);
+
+  texture.Clear(Color(0u, 0u, 0u, 0u));
+  ASSERT_TRUE(rasterizer.FillLinearGradient(texture, {0.0f, 0.0f},
+                                            {32.0f, 0.0f}, kColorBlack,
+                                            kColorWhite));
+  ASSERT_NEAR(texture.GetRed({0u, 4u})[0], 4, 1);
+  ASSERT_NEAR(texture.GetRed({15u, 4u})[0], 124, 1);
+  ASSERT_EQ(texture.GetRed({31u, 4u})[0], 251u);
+  ASSERT_EQ(texture.GetAlpha({15u, 4u})[0], 255u);
+  ASSERT_EQ(texture.GetAlpha({15u, 20u})[0], 0u);
+
+  Texture small;
+  ASSERT_TRUE(small.Resize({8u, 8u}));
+  ASSERT_FALSE(rasterizer.Fill(small, kColorRed));
+}
+
 TEST_F(MerleTest, AverageColorApply) {
   Application application;
   auto texture = std::make_shared<Texture>();
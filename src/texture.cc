@@ -6,9 +6,14 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <cstring>
 #include <optional>
 
+#include "remap_table.h"
 #include "texture_ispc.h"
 
 namespace merle {
@@ -47,26 +52,142 @@ std::optional<Texture> Texture::CreateFromFile(const char* name) {
   return texture;
 }
 
+Texture::Texture(uint8_t* allocation, UPoint size, ReleaseProc release_proc) {
+  SetAllocation(std::shared_ptr<uint8_t>(allocation, std::move(release_proc)),
+                size);
+}
+
+void Texture::SetAllocation(std::shared_ptr<uint8_t> allocation, UPoint size) {
+  // Each plane gets its own reference count. The block is released once the
+  // last plane referencing it is gone.
+  for (size_t i = 0; i < planes_.size(); i++) {
+    planes_[i] = std::shared_ptr<uint8_t>(allocation.get() + size.GetArea() * i,
+                                          [allocation](uint8_t*) {});
+  }
+  allocation_ = std::move(allocation);
+  size_ = size;
+}
+
+bool Texture::Resize(UPoint size) {
+  if (size_ == size) {
+    return true;
+  }
+  auto allocation = reinterpret_cast<uint8_t*>(
+      std::malloc(size.GetArea() * GetBytesPerPixel()));
+  if (allocation == nullptr) {
+    return false;
+  }
+  SetAllocation(std::shared_ptr<uint8_t>(allocation, std::free), size);
+  return true;
+}
+
+Texture Texture::CloneRows(uint32_t y, uint32_t rows) const {
+  Texture clone;
+  y = std::min(y, size_.y);
+  rows = std::min(rows, size_.y - y);
+  for (size_t i = 0; i < planes_.size(); i++) {
+    if (planes_[i]) {
+      // Shares the reference count of the plane so that writes to either
+      // texture copy it first.
+      clone.planes_[i] = std::shared_ptr<uint8_t>(
+          planes_[i], planes_[i].get() + static_cast<size_t>(size_.x) * y);
+    }
+  }
+  clone.allocation_ = allocation_;
+  clone.size_ = {size_.x, rows};
+  return clone;
+}
+
+bool Texture::MakePlaneUnique(Component comp, bool preserve_contents) {
+  auto& plane = planes_[static_cast<uint8_t>(comp)];
+  if (!plane) {
+    return true;
+  }
+  if (plane.use_count() == 1) {
+    // The count is read relaxed. Order the reads other threads made of the
+    // plane before dropping their copies before the writes to come.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+  }
+  auto copy = reinterpret_cast<uint8_t*>(std::malloc(GetPixelCount()));
+  if (copy == nullptr) {
+    return false;
+  }
+  if (preserve_contents) {
+    ::memcpy(copy, plane.get(), GetPixelCount());
+  }
+  plane = std::shared_ptr<uint8_t>(copy, std::free);
+  return true;
+}
+
+bool Texture::MakePlanesUnique(std::span<const Component> comps,
+                               bool preserve_contents) {
+  for (auto comp : comps) {
+    if (!MakePlaneUnique(comp, preserve_contents)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint8_t* Texture::GetContiguousAllocationMutable() {
+  bool is_contiguous = static_cast<bool>(allocation_);
+  for (size_t i = 0; i < planes_.size() && is_contiguous; i++) {
+    is_contiguous = planes_[i].use_count() == 1 &&
+                    planes_[i].get() == allocation_.get() + GetPixelCount() * i;
+  }
+  if (is_contiguous) {
+    // See `MakePlaneUnique`.
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  if (!is_contiguous && allocation_) {
+    // The block may be referenced by planes of other components. Don't
+    // clobber it.
+    const auto size = size_;
+    size_ = {};
+    if (!Resize(size)) {
+      return nullptr;
+    }
+  }
+  return allocation_.get();
+}
+
 void Texture::Clear(Color color,
                     bool clear_red,
                     bool clear_green,
                     bool clear_blue,
                     bool clear_alpha) {
-  if (clear_red) {
+  // Every pixel is overwritten, so shared planes are replaced, not copied.
+  if (clear_red && MakePlaneUnique(Component::kRed, false)) {
     ::memset(GetRedMutable(), color.red, GetPixelCount());
   }
-  if (clear_green) {
+  if (clear_green && MakePlaneUnique(Component::kGreen, false)) {
     ::memset(GetGreenMutable(), color.green, GetPixelCount());
   }
-  if (clear_blue) {
+  if (clear_blue && MakePlaneUnique(Component::kBlue, false)) {
     ::memset(GetBlueMutable(), color.blue, GetPixelCount());
   }
-  if (clear_alpha) {
+  if (clear_alpha && MakePlaneUnique(Component::kAlpha, false)) {
     ::memset(GetAlphaMutable(), color.alpha, GetPixelCount());
   }
 }
 
-void Texture::PremultiplyAlpha() {
+void Texture::PremultiplyAlpha(LightSpace space) {
+  if (space == LightSpace::kLinear) {
+    if (!MakePlanesUnique(kColorComponents)) {
+      return;
+    }
+    ispc::PremultiplyAlphaLinear(GetRedMutable(),    // r
+                                 GetGreenMutable(),  // g
+                                 GetBlueMutable(),   // b
+                                 GetAlpha(),         // a
+                                 GetPixelCount()     // length
+    );
+    return;
+  }
+  if (!MakePlanesUnique(kComponents)) {
+    return;
+  }
   ispc::PremultiplyAlpha(GetRedMutable(),    // r
                          GetGreenMutable(),  // g
                          GetBlueMutable(),   // b
@@ -76,6 +197,9 @@ void Texture::PremultiplyAlpha() {
 }
 
 void Texture::Grayscale() {
+  if (!MakePlanesUnique(kColorComponents)) {
+    return;
+  }
   ispc::Grayscale(GetRedMutable(),    // red
                   GetGreenMutable(),  // green
                   GetBlueMutable(),   // blue
@@ -90,25 +214,30 @@ void Texture::Replace(const Texture& texture, Point offset) {
       Rect{Size{static_cast<int32_t>(size_.x), static_cast<int32_t>(size_.y)}}
           .Intersection(src_rect);
 
-  if (!dst_rect.has_value()) {
+  if (!dst_rect.has_value() || !MakePlanesUnique(kComponents)) {
     return;
   }
 
+  // The clipped rect is in this texture. Sources placed up or to the left
+  // of it start part way in.
   for (auto y = 0; y < dst_rect->size.y; y++) {
-    const auto src_point = UPoint{static_cast<uint32_t>(offset.x),
-                                  static_cast<uint32_t>(offset.y + y)};
-    const auto dst_point = UPoint(0, static_cast<uint32_t>(y));
-    ::memcpy(GetAllocationMutable(Component::kRed, src_point),   //
-             texture.GetAllocation(Component::kRed, dst_point),  //
+    const auto dst_point =
+        UPoint{static_cast<uint32_t>(dst_rect->origin.x),
+               static_cast<uint32_t>(dst_rect->origin.y + y)};
+    const auto src_point =
+        UPoint{static_cast<uint32_t>(dst_rect->origin.x - offset.x),
+               static_cast<uint32_t>(dst_rect->origin.y - offset.y + y)};
+    ::memcpy(GetAllocationMutable(Component::kRed, dst_point),   //
+             texture.GetAllocation(Component::kRed, src_point),  //
              dst_rect->size.x);
-    ::memcpy(GetAllocationMutable(Component::kGreen, src_point),   //
-             texture.GetAllocation(Component::kGreen, dst_point),  //
+    ::memcpy(GetAllocationMutable(Component::kGreen, dst_point),   //
+             texture.GetAllocation(Component::kGreen, src_point),  //
              dst_rect->size.x);
-    ::memcpy(GetAllocationMutable(Component::kBlue, src_point),   //
-             texture.GetAllocation(Component::kBlue, dst_point),  //
+    ::memcpy(GetAllocationMutable(Component::kBlue, dst_point),   //
+             texture.GetAllocation(Component::kBlue, src_point),  //
              dst_rect->size.x);
-    ::memcpy(GetAllocationMutable(Component::kAlpha, src_point),   //
-             texture.GetAllocation(Component::kAlpha, dst_point),  //
+    ::memcpy(GetAllocationMutable(Component::kAlpha, dst_point),   //
+             texture.GetAllocation(Component::kAlpha, src_point),  //
              dst_rect->size.x);
   }
 }
@@ -117,18 +246,46 @@ bool Texture::CopyToRGBA(Texture& texture) const {
   if (texture.GetSize() != GetSize()) {
     return false;
   }
-  ispc::CopyToRGBA(GetRed(),    // red
-                   GetGreen(),  // green
-                   GetBlue(),   // blue
-                   GetAlpha(),  // alpha
-                   reinterpret_cast<ispc::Color*>(
-                       texture.GetAllocationMutable()),  // color(out)
-                   GetPixelCount()                       // length
+  auto* rgba = texture.GetContiguousAllocationMutable();
+  if (rgba == nullptr) {
+    return false;
+  }
+  ispc::CopyToRGBA(GetRed(),                              // red
+                   GetGreen(),                            // green
+                   GetBlue(),                             // blue
+                   GetAlpha(),                            // alpha
+                   reinterpret_cast<ispc::Color*>(rgba),  // color(out)
+                   GetPixelCount()                        // length
   );
   return true;
 }
 
+void Texture::CopyToRGB565(uint16_t* rgb565, bool dither) const {
+  ispc::CopyToRGB565(GetRed(),    // red
+                     GetGreen(),  // green
+                     GetBlue(),   // blue
+                     rgb565,      // rgb565(out)
+                     size_.x,     // width
+                     size_.y,     // height
+                     dither       // dither
+  );
+}
+
+void Texture::CopyToRGB332(uint8_t* rgb332, bool dither) const {
+  ispc::CopyToRGB332(GetRed(),    // red
+                     GetGreen(),  // green
+                     GetBlue(),   // blue
+                     rgb332,      // rgb332(out)
+                     size_.x,     // width
+                     size_.y,     // height
+                     dither       // dither
+  );
+}
+
 void Texture::Invert() {
+  if (!MakePlanesUnique(kColorComponents)) {
+    return;
+  }
   ispc::Invert(GetRedMutable(),    // red
                GetGreenMutable(),  // green
                GetBlueMutable(),   // blue
@@ -137,6 +294,9 @@ void Texture::Invert() {
 }
 
 void Texture::Exposure(float exposure) {
+  if (!MakePlanesUnique(kColorComponents)) {
+    return;
+  }
   ispc::Exposure(GetRedMutable(),    // red
                  GetGreenMutable(),  // green
                  GetBlueMutable(),   // blue
@@ -146,6 +306,9 @@ void Texture::Exposure(float exposure) {
 }
 
 void Texture::Brightness(float brightness) {
+  if (!MakePlanesUnique(kColorComponents)) {
+    return;
+  }
   ispc::Brightness(GetRedMutable(),    // red
                    GetGreenMutable(),  // green
                    GetBlueMutable(),   // blue
@@ -155,6 +318,9 @@ void Texture::Brightness(float brightness) {
 }
 
 void Texture::RGBALevels(float red, float green, float blue, float alpha) {
+  if (!MakePlanesUnique(kComponents)) {
+    return;
+  }
   ispc::RGBALevels(GetRedMutable(),    // red
                    GetGreenMutable(),  // green
                    GetBlueMutable(),   // blue
@@ -171,19 +337,23 @@ void Texture::Swizzle(Component red,
                       Component green,
                       Component blue,
                       Component alpha) {
-  ispc::Swizzle(GetRedMutable(),                      // red
-                GetGreenMutable(),                    // green
-                GetBlueMutable(),                     // blue
-                GetAlphaMutable(),                    // alpha
-                static_cast<ispc::Component>(red),    // red swizzle
-                static_cast<ispc::Component>(green),  // green swizzle
-                static_cast<ispc::Component>(blue),   // blue swizzle
-                static_cast<ispc::Component>(alpha),  // alpha swizzle
-                GetPixelCount()                       // length
-  );
+  // Only the plane table is permuted. Planes referenced by more than one
+  // component are copied when one of them is written to.
+  const auto planes = planes_;
+  planes_[static_cast<uint8_t>(Component::kRed)] =
+      planes[static_cast<uint8_t>(red)];
+  planes_[static_cast<uint8_t>(Component::kGreen)] =
+      planes[static_cast<uint8_t>(green)];
+  planes_[static_cast<uint8_t>(Component::kBlue)] =
+      planes[static_cast<uint8_t>(blue)];
+  planes_[static_cast<uint8_t>(Component::kAlpha)] =
+      planes[static_cast<uint8_t>(alpha)];
 }
 
 void Texture::ColorMatrix(const Matrix& matrix) {
+  if (!MakePlanesUnique(kComponents)) {
+    return;
+  }
   ispc::ColorMatrix(GetRedMutable(),    // red
                     GetGreenMutable(),  // green
                     GetBlueMutable(),   // blue
@@ -192,16 +362,23 @@ void Texture::ColorMatrix(const Matrix& matrix) {
                     reinterpret_cast<const ispc::Matrix&>(matrix.e));
 }
 
-void Texture::Sepia() {
-  ColorMatrix(Matrix{
+Matrix Texture::CreateSepiaMatrix() {
+  return Matrix{
       0.3588, 0.7044, 0.1368, 0.0,  //
       0.2990, 0.5870, 0.1140, 0.0,  //
       0.2392, 0.4696, 0.0912, 0.0,  //
       0, 0, 0, 1.0,                 //
-  });
+  };
+}
+
+void Texture::Sepia() {
+  ColorMatrix(CreateSepiaMatrix());
 }
 
 void Texture::Contrast(float contrast) {
+  if (!MakePlanesUnique(kColorComponents)) {
+    return;
+  }
   ispc::Contrast(GetRedMutable(),    // red
                  GetGreenMutable(),  // green
                  GetBlueMutable(),   // blue
@@ -211,16 +388,21 @@ void Texture::Contrast(float contrast) {
 }
 
 void Texture::Saturation(float saturation) {
-  const auto length = size_.x * size_.y;
+  if (!MakePlanesUnique(kColorComponents)) {
+    return;
+  }
   ispc::Saturation(GetRedMutable(),    // red
                    GetGreenMutable(),  // green
                    GetBlueMutable(),   // blue
-                   length,             // length
+                   GetPixelCount(),    // length
                    saturation          // saturation
   );
 }
 
 void Texture::Vibrance(float vibrance) {
+  if (!MakePlanesUnique(kColorComponents)) {
+    return;
+  }
   ispc::Saturation(GetRedMutable(),    // red
                    GetGreenMutable(),  // green
                    GetBlueMutable(),   // blue
@@ -230,6 +412,9 @@ void Texture::Vibrance(float vibrance) {
 }
 
 void Texture::Hue(Radians hue) {
+  if (!MakePlanesUnique(kColorComponents)) {
+    return;
+  }
   ispc::Hue(GetRedMutable(),    // red
             GetGreenMutable(),  // green
             GetBlueMutable(),   // blue
@@ -239,6 +424,9 @@ void Texture::Hue(Radians hue) {
 }
 
 void Texture::Opacity(UnitScalarF opacity) {
+  if (!MakePlaneUnique(Component::kAlpha)) {
+    return;
+  }
   ispc::Opacity(GetAlphaMutable(),  // alphas
                 GetPixelCount(),    // length
                 opacity             // opacity
@@ -254,6 +442,9 @@ float Texture::AverageLuminance() const {
 }
 
 void Texture::LuminanceThreshold(float luminance) {
+  if (!MakePlanesUnique(kColorComponents)) {
+    return;
+  }
   ispc::LuminanceThreshold(GetRedMutable(),    // red
                            GetGreenMutable(),  // green
                            GetBlueMutable(),   // blue
@@ -262,14 +453,17 @@ void Texture::LuminanceThreshold(float luminance) {
   );
 }
 
-bool Texture::BoxBlur(const Texture& src, uint8_t radius) {
+std::vector<float> Texture::CreateBoxKernel(uint8_t radius) {
   const auto kernel_width = 2 * radius + 1;
   const auto kernel_length = kernel_width * kernel_width;
-  std::vector<float> kernel(kernel_length, 1.0f / kernel_length);
-  return ConvolutionNxN(src, kernel);
+  return std::vector<float>(kernel_length, 1.0f / kernel_length);
 }
 
-static std::vector<float> CreateGaussianKernel(uint8_t radius, float sigma) {
+bool Texture::BoxBlur(const Texture& src, uint8_t radius, LightSpace space) {
+  return ConvolutionNxN(src, CreateBoxKernel(radius), space);
+}
+
+std::vector<float> Texture::CreateGaussianKernel(uint8_t radius, float sigma) {
   std::vector<float> kernel;
   size_t kernel_width = 2 * radius + 1;
   kernel.resize(kernel_width * kernel_width);
@@ -295,14 +489,25 @@ static std::vector<float> CreateGaussianKernel(uint8_t radius, float sigma) {
   return kernel;
 }
 
-bool Texture::GaussianBlur(const Texture& src, uint8_t radius, float sigma) {
-  return ConvolutionNxN(src, CreateGaussianKernel(radius, sigma));
+bool Texture::GaussianBlur(const Texture& src,
+                           uint8_t radius,
+                           float sigma,
+                           LightSpace space) {
+  return ConvolutionNxN(src, CreateGaussianKernel(radius, sigma), space);
+}
+
+void Texture::BoxBlur(uint8_t radius, LightSpace space) {
+  ConvolutionNxN(CreateBoxKernel(radius), space);
+}
+
+void Texture::GaussianBlur(uint8_t radius, float sigma, LightSpace space) {
+  ConvolutionNxN(CreateGaussianKernel(radius, sigma), space);
 }
 
 bool Texture::Sobel(const Texture& src,
                     Component src_component,
                     Component dst_component) {
-  if (size_ != src.size_) {
+  if (size_ != src.size_ || !MakePlaneUnique(dst_component)) {
     return false;
   }
 
@@ -315,21 +520,30 @@ bool Texture::Sobel(const Texture& src,
 }
 
 void Texture::DuplicateChannel(Component src, Component dst) {
-  if (src == dst) {
-    return;
-  }
-
-  ::memmove(GetAllocationMutable(dst),  // dst
-            GetAllocation(src),         // src
-            GetPixelCount()             // length
-  );
+  planes_[static_cast<uint8_t>(dst)] = planes_[static_cast<uint8_t>(src)];
 }
 
 bool Texture::ConvolutionNxN(const Texture& src,
-                             const std::vector<float>& kernel) {
-  if (size_ != src.size_) {
+                             const std::vector<float>& kernel,
+                             LightSpace space) {
+  if (size_ != src.size_ || !MakePlanesUnique(kComponents)) {
     return false;
   }
+  if (space == LightSpace::kLinear) {
+    // Each plane is decoded a row at a time as the kernel reaches it.
+    for (auto comp : kComponents) {
+      const auto type = comp == Component::kAlpha ? ispc::kU8 : ispc::kSRGB8;
+      ispc::ConvolutionNxNPlane(src.GetAllocation(comp),            // src
+                                GetAllocationMutable(comp),         // dst
+                                type,                               // type
+                                size_.x,                            // width
+                                size_.y,                            // height
+                                const_cast<float*>(kernel.data()),  // kernel
+                                kernel.size()  // kernel size
+      );
+    }
+    return true;
+  }
   ispc::ConvolutionNxN(src.GetRed(),                       // src r
                        src.GetGreen(),                     // src g
                        src.GetBlue(),                      // src b
@@ -346,13 +560,63 @@ bool Texture::ConvolutionNxN(const Texture& src,
   return true;
 }
 
+void Texture::ConvolutionNxN(const std::vector<float>& kernel,
+                             LightSpace space) {
+  if (!MakePlanesUnique(kComponents)) {
+    return;
+  }
+  if (space == LightSpace::kLinear) {
+    auto* weights = const_cast<float*>(kernel.data());
+    for (auto comp : kComponents) {
+      const auto type = comp == Component::kAlpha ? ispc::kU8 : ispc::kSRGB8;
+      ispc::ConvolutionNxNPlaneInPlace(GetAllocationMutable(comp),  // plane
+                                       type,                        // type
+                                       size_.x,                     // width
+                                       size_.y,                     // height
+                                       weights,                     // kernel
+                                       kernel.size()  // kernel size
+      );
+    }
+    return;
+  }
+  ispc::ConvolutionNxNInPlace(GetRedMutable(),                    // r
+                              GetGreenMutable(),                  // g
+                              GetBlueMutable(),                   // b
+                              GetAlphaMutable(),                  // a
+                              size_.x,                            // width
+                              size_.y,                            // height
+                              const_cast<float*>(kernel.data()),  // kernel
+                              kernel.size()                       // kernel size
+  );
+}
+
 bool Texture::FadeTransition(const Texture& from,
                              const Texture& to,
-                             UnitScalarF t) {
-  if (from.size_ != to.size_) {
+                             UnitScalarF t,
+                             LightSpace space) {
+  if (from.size_ != to.size_ || !MakePlanesUnique(kComponents)) {
     return false;
   }
 
+  if (space == LightSpace::kLinear) {
+    ispc::FadeTransitionLinear(GetRedMutable(),    // dst_r
+                               GetGreenMutable(),  // dst_g
+                               GetBlueMutable(),   // dst_b
+                               GetAlphaMutable(),  // dst_a
+                               from.GetRed(),      // from_r
+                               from.GetGreen(),    // from_g
+                               from.GetBlue(),     // from_b
+                               from.GetAlpha(),    // from_a
+                               to.GetRed(),        // to_r
+                               to.GetGreen(),      // to_g
+                               to.GetBlue(),       // to_b
+                               to.GetAlpha(),      // to_a
+                               GetPixelCount(),    // len
+                               t                   // t
+    );
+    return true;
+  }
+
   ispc::FadeTransition(GetRedMutable(),    // dst_r
                        GetGreenMutable(),  // dst_g
                        GetBlueMutable(),   // dst_b
@@ -375,7 +639,7 @@ bool Texture::SwipeTransition(const Texture& from,
                               const Texture& to,
                               UnitScalarF t,
                               Direction direction) {
-  if (from.size_ != to.size_) {
+  if (from.size_ != to.size_ || !MakePlanesUnique(kComponents)) {
     return false;
   }
 
@@ -439,4 +703,414 @@ bool Texture::IsOpaque() const {
   );
 }
 
+// The taps of one axis of a resample. Every destination index has tap_count
+// taps. Source indices are clamped to the edge and weights sum to one.
+struct ResampleTaps {
+  std::vector<int32_t> indices;
+  std::vector<float> weights;
+  size_t tap_count = 0u;
+};
+
+static float Sinc(float x) {
+  if (x == 0.0f) {
+    return 1.0f;
+  }
+  x *= kPi;
+  return std::sin(x) / x;
+}
+
+// The distance from the center past which the filter is zero, in pixels of
+// the larger of the source and destination.
+static float GetFilterSupport(Texture::ResampleFilter filter) {
+  switch (filter) {
+    case Texture::ResampleFilter::kBilinear:
+      return 1.0f;
+    case Texture::ResampleFilter::kBicubic:
+      return 2.0f;
+    case Texture::ResampleFilter::kLanczos3:
+      return 3.0f;
+    case Texture::ResampleFilter::kArea:
+      return 0.5f;
+  }
+  return 1.0f;
+}
+
+static float EvaluateFilter(Texture::ResampleFilter filter, float x) {
+  x = std::abs(x);
+  switch (filter) {
+    case Texture::ResampleFilter::kBilinear:
+      return std::max(1.0f - x, 0.0f);
+    case Texture::ResampleFilter::kBicubic:
+      // Catmull-Rom.
+      if (x < 1.0f) {
+        return (1.5f * x - 2.5f) * x * x + 1.0f;
+      }
+      if (x < 2.0f) {
+        return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+      }
+      return 0.0f;
+    case Texture::ResampleFilter::kLanczos3:
+      return x < 3.0f ? Sinc(x) * Sinc(x / 3.0f) : 0.0f;
+    case Texture::ResampleFilter::kArea:
+      return x <= 0.5f ? 1.0f : 0.0f;
+  }
+  return 0.0f;
+}
+
+static ResampleTaps ComputeResampleTaps(uint32_t src_size,
+                                        uint32_t dst_size,
+                                        Texture::ResampleFilter filter) {
+  const float scale = static_cast<float>(src_size) / dst_size;
+  // Stretch the filter over the source when downscaling so every source pixel
+  // contributes.
+  const float filter_scale = std::max(scale, 1.0f);
+  const float support = GetFilterSupport(filter) * filter_scale;
+
+  ResampleTaps taps;
+  taps.tap_count = static_cast<size_t>(std::ceil(2.0f * support)) + 1u;
+  taps.indices.resize(taps.tap_count * dst_size);
+  taps.weights.resize(taps.tap_count * dst_size);
+  for (uint32_t d = 0u; d < dst_size; d++) {
+    const float center = (d + 0.5f) * scale;
+    const int64_t first = static_cast<int64_t>(std::floor(center - support));
+    int32_t* indices = taps.indices.data() + d * taps.tap_count;
+    float* weights = taps.weights.data() + d * taps.tap_count;
+    float total = 0.0f;
+    for (size_t k = 0u; k < taps.tap_count; k++) {
+      const int64_t i = first + static_cast<int64_t>(k);
+      float weight = 0.0f;
+      if (filter == Texture::ResampleFilter::kArea) {
+        // The overlap of the source pixel with the destination pixel.
+        weight = std::max(std::min(i + 1.0f, center + scale / 2.0f) -
+                              std::max(static_cast<float>(i),
+                                       center - scale / 2.0f),
+                          0.0f);
+      } else {
+        weight = EvaluateFilter(filter, (i + 0.5f - center) / filter_scale);
+      }
+      indices[k] = static_cast<int32_t>(
+          std::clamp<int64_t>(i, 0, static_cast<int64_t>(src_size) - 1));
+      weights[k] = weight;
+      total += weight;
+    }
+    for (size_t k = 0u; k < taps.tap_count; k++) {
+      weights[k] = total != 0.0f ? weights[k] / total : 0.0f;
+    }
+  }
+  return taps;
+}
+
+bool Texture::Resample(Texture& dst,
+                       ResampleFilter filter,
+                       bool alpha_weighted) const {
+  if (dst.size_.GetArea() == 0u) {
+    return true;
+  }
+  if (size_.GetArea() == 0u || &dst == this ||
+      !dst.MakePlanesUnique(kComponents, /*preserve_contents=*/false)) {
+    return false;
+  }
+
+  if (filter == ResampleFilter::kArea && size_.x % dst.size_.x == 0u &&
+      size_.y % dst.size_.y == 0u) {
+    ispc::ResampleBox(GetRed(),               // src_r
+                      GetGreen(),             // src_g
+                      GetBlue(),              // src_b
+                      GetAlpha(),             // src_a
+                      dst.GetRedMutable(),    // dst_r
+                      dst.GetGreenMutable(),  // dst_g
+                      dst.GetBlueMutable(),   // dst_b
+                      dst.GetAlphaMutable(),  // dst_a
+                      size_.x,                // src_width
+                      dst.size_.x,            // dst_width
+                      dst.size_.y,            // dst_height
+                      size_.x / dst.size_.x,  // x_factor
+                      size_.y / dst.size_.y,  // y_factor
+                      alpha_weighted          // alpha_weighted
+    );
+    return true;
+  }
+
+  const auto x_taps = ComputeResampleTaps(size_.x, dst.size_.x, filter);
+  const auto y_taps = ComputeResampleTaps(size_.y, dst.size_.y, filter);
+  ispc::Resample(GetRed(),               // src_r
+                 GetGreen(),             // src_g
+                 GetBlue(),              // src_b
+                 GetAlpha(),             // src_a
+                 dst.GetRedMutable(),    // dst_r
+                 dst.GetGreenMutable(),  // dst_g
+                 dst.GetBlueMutable(),   // dst_b
+                 dst.GetAlphaMutable(),  // dst_a
+                 size_.x,                // src_width
+                 dst.size_.x,            // dst_width
+                 dst.size_.y,            // dst_height
+                 x_taps.indices.data(),  // x_indices
+                 x_taps.weights.data(),  // x_weights
+                 x_taps.tap_count,       // x_tap_count
+                 y_taps.indices.data(),  // y_indices
+                 y_taps.weights.data(),  // y_weights
+                 y_taps.tap_count,       // y_tap_count
+                 alpha_weighted          // alpha_weighted
+  );
+  return true;
+}
+
+std::optional<std::vector<Texture>> Texture::BuildPyramid(
+    uint32_t levels) const {
+  if (levels == 0u || size_.GetArea() == 0u) {
+    return std::nullopt;
+  }
+  std::vector<UPoint> sizes = {size_};
+  size_t bytes = 0u;
+  while (sizes.size() < levels && sizes.back() != UPoint{1u, 1u}) {
+    const UPoint size = {std::max(sizes.back().x / 2u, 1u),
+                         std::max(sizes.back().y / 2u, 1u)};
+    sizes.push_back(size);
+    bytes += size.GetArea() * GetBytesPerPixel();
+  }
+
+  std::vector<Texture> pyramid;
+  pyramid.push_back(Clone());
+  if (sizes.size() == 1u) {
+    return pyramid;
+  }
+  auto allocation = std::shared_ptr<uint8_t>(
+      reinterpret_cast<uint8_t*>(std::malloc(bytes)), std::free);
+  if (!allocation) {
+    return std::nullopt;
+  }
+
+  std::vector<uint8_t*> planes;
+  std::vector<int64_t> widths;
+  std::vector<int64_t> heights;
+  size_t offset = 0u;
+  for (size_t i = 0; i < sizes.size(); i++) {
+    if (i > 0u) {
+      Texture level;
+      level.SetAllocation(
+          std::shared_ptr<uint8_t>(allocation, allocation.get() + offset),
+          sizes[i]);
+      offset += level.GetPixelCount() * GetBytesPerPixel();
+      pyramid.push_back(std::move(level));
+    }
+    for (auto comp : kComponents) {
+      // The planes of the first level are only read.
+      planes.push_back(i == 0u ? const_cast<uint8_t*>(GetAllocation(comp))
+                               : pyramid[i].GetAllocationMutable(comp));
+    }
+    widths.push_back(sizes[i].x);
+    heights.push_back(sizes[i].y);
+  }
+
+  ispc::BuildPyramid(planes.data(),   // planes
+                     widths.data(),   // widths
+                     heights.data(),  // heights
+                     sizes.size()     // level_count
+  );
+  return pyramid;
+}
+
+bool Texture::Warp(const Texture& src, const Transform& transform) {
+  if (&src == this) {
+    return false;
+  }
+  const auto inverse = transform.Invert();
+  if (!inverse.has_value()) {
+    return false;
+  }
+  if (size_.GetArea() == 0u || src.size_.GetArea() == 0u) {
+    return true;
+  }
+  if (!MakePlanesUnique(kComponents)) {
+    return false;
+  }
+  ispc::Warp(src.GetRed(),       // src_r
+             src.GetGreen(),     // src_g
+             src.GetBlue(),      // src_b
+             src.GetAlpha(),     // src_a
+             GetRedMutable(),    // dst_r
+             GetGreenMutable(),  // dst_g
+             GetBlueMutable(),   // dst_b
+             GetAlphaMutable(),  // dst_a
+             src.size_.x,        // src_width
+             src.size_.y,        // src_height
+             size_.x,            // dst_width
+             size_.y,            // dst_height
+             inverse->m          // inverse
+  );
+  return true;
+}
+
+bool Texture::Remap(const Texture& src, const RemapTable& table) {
+  if (&src == this || src.size_ != table.GetSourceSize() ||
+      size_ != table.GetSize()) {
+    return false;
+  }
+  if (size_.GetArea() == 0u || src.size_.GetArea() == 0u) {
+    return true;
+  }
+  if (!MakePlanesUnique(kComponents)) {
+    return false;
+  }
+  ispc::Remap(src.GetRed(),          // src_r
+              src.GetGreen(),        // src_g
+              src.GetBlue(),         // src_b
+              src.GetAlpha(),        // src_a
+              GetRedMutable(),       // dst_r
+              GetGreenMutable(),     // dst_g
+              GetBlueMutable(),      // dst_b
+              GetAlphaMutable(),     // dst_a
+              table.GetPoints(),     // points
+              table.GetFractions(),  // fractions
+              src.size_.x,           // src_width
+              src.size_.y,           // src_height
+              size_.x,               // dst_width
+              size_.y                // dst_height
+  );
+  return true;
+}
+
+static bool TransposeTexture(const Texture& src,
+                             Texture& dst,
+                             bool flip_x,
+                             bool flip_y) {
+  const auto size = src.GetSize();
+  if (&src == &dst || dst.GetSize() != UPoint{size.y, size.x} ||
+      !dst.MakePlanesUnique(kComponents, /*preserve_contents=*/false)) {
+    return false;
+  }
+  std::array<const uint8_t*, 4u> src_planes;
+  std::array<uint8_t*, 4u> dst_planes;
+  for (size_t i = 0; i < kComponents.size(); i++) {
+    src_planes[i] = src.GetAllocation(kComponents[i]);
+    dst_planes[i] = dst.GetAllocationMutable(kComponents[i]);
+  }
+  ispc::Transpose(src_planes.data(),  // src_planes
+                  dst_planes.data(),  // dst_planes
+                  size.x,             // src_width
+                  size.y,             // src_height
+                  flip_x,             // flip_x
+                  flip_y              // flip_y
+  );
+  return true;
+}
+
+static bool FlipTexture(const Texture& src,
+                        Texture& dst,
+                        bool flip_x,
+                        bool flip_y) {
+  const auto size = src.GetSize();
+  if (&src == &dst || dst.GetSize() != size ||
+      !dst.MakePlanesUnique(kComponents, /*preserve_contents=*/false)) {
+    return false;
+  }
+  std::array<const uint8_t*, 4u> src_planes;
+  std::array<uint8_t*, 4u> dst_planes;
+  for (size_t i = 0; i < kComponents.size(); i++) {
+    src_planes[i] = src.GetAllocation(kComponents[i]);
+    dst_planes[i] = dst.GetAllocationMutable(kComponents[i]);
+  }
+  ispc::Flip(src_planes.data(),  // src_planes
+             dst_planes.data(),  // dst_planes
+             size.x,             // width
+             size.y,             // height
+             flip_x,             // flip_x
+             flip_y              // flip_y
+  );
+  return true;
+}
+
+bool Texture::Transpose(const Texture& src) {
+  return TransposeTexture(src, *this, false, false);
+}
+
+bool Texture::Rotate90(const Texture& src) {
+  return TransposeTexture(src, *this, false, true);
+}
+
+bool Texture::Rotate270(const Texture& src) {
+  return TransposeTexture(src, *this, true, false);
+}
+
+bool Texture::Rotate180(const Texture& src) {
+  return FlipTexture(src, *this, true, true);
+}
+
+bool Texture::Flip(const Texture& src, Direction direction) {
+  return FlipTexture(src, *this, direction == Direction::kHorizontal,
+                     direction == Direction::kVertical);
+}
+
+bool Texture::Composite(const Texture& src,
+                        Point point,
+                        CompositeMode mode,
+                        UnitScalarF opacity,
+                        AlphaType alpha_type) {
+  if (&src == this) {
+    return false;
+  }
+  const auto rect =
+      Rect{Size{static_cast<int32_t>(size_.x), static_cast<int32_t>(size_.y)}}
+          .Intersection(Rect{point, Size{static_cast<int32_t>(src.size_.x),
+                                         static_cast<int32_t>(src.size_.y)}});
+  if (!rect.has_value() || rect->size.GetArea() == 0) {
+    return true;
+  }
+  if (!MakePlanesUnique(kComponents)) {
+    return false;
+  }
+  const auto dst_origin = UPoint{static_cast<uint32_t>(rect->origin.x),
+                                 static_cast<uint32_t>(rect->origin.y)};
+  const auto src_origin =
+      UPoint{static_cast<uint32_t>(rect->origin.x - point.x),
+             static_cast<uint32_t>(rect->origin.y - point.y)};
+  std::array<const uint8_t*, 4u> src_planes;
+  std::array<uint8_t*, 4u> dst_planes;
+  for (size_t i = 0; i < kComponents.size(); i++) {
+    src_planes[i] = src.GetAllocation(kComponents[i], src_origin);
+    dst_planes[i] = GetAllocationMutable(kComponents[i], dst_origin);
+  }
+  const auto fixed_opacity =
+      static_cast<uint32_t>(std::lround(opacity * 255.0f));
+  ispc::Composite(src_planes.data(),                       // src_planes
+                  dst_planes.data(),                       // dst_planes
+                  src.size_.x,                             // src_stride
+                  size_.x,                                 // dst_stride
+                  rect->size.x,                            // width
+                  rect->size.y,                            // height
+                  static_cast<ispc::CompositeMode>(mode),  // mode
+                  fixed_opacity,                           // opacity
+                  alpha_type == AlphaType::kPremultiplied  // premultiplied
+  );
+  return true;
+}
+
+bool Texture::Blend(const Texture& bottom,
+                    const Texture& top,
+                    BlendMode mode,
+                    UnitScalarF opacity) {
+  // Make this texture unique first in case it shares planes with a layer.
+  if (bottom.size_ != top.size_ || !Resize(bottom.size_) ||
+      !MakePlanesUnique(kComponents)) {
+    return false;
+  }
+  std::array<uint8_t*, 4u> dst_planes;
+  std::array<const uint8_t*, 4u> bottom_planes;
+  std::array<const uint8_t*, 4u> top_planes;
+  for (size_t i = 0; i < kComponents.size(); i++) {
+    dst_planes[i] = GetAllocationMutable(kComponents[i]);
+    bottom_planes[i] = bottom.GetAllocation(kComponents[i]);
+    top_planes[i] = top.GetAllocation(kComponents[i]);
+  }
+  ispc::Blend(dst_planes.data(),                   // dst_planes
+              bottom_planes.data(),                // bottom_planes
+              top_planes.data(),                   // top_planes
+              size_.x,                             // width
+              size_.y,                             // height
+              static_cast<ispc::BlendMode>(mode),  // mode
+              opacity                              // opacity
+  );
+  return true;
+}
+
 }  // namespace merle
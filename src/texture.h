@@ -1,7 +1,11 @@
 #pragma once
 
 #include <stdint.h>
+#include <array>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <span>
 #include <vector>
 
 #include "geom.h"
@@ -9,6 +13,8 @@
 
 namespace merle {
 
+class RemapTable;
+
 enum class Component : uint8_t {
   kRed,
   kGreen,
@@ -16,35 +22,161 @@ enum class Component : uint8_t {
   kAlpha,
 };
 
+// Every component, in plane order.
+inline constexpr std::array<Component, 4u> kComponents = {
+    Component::kRed, Component::kGreen, Component::kBlue, Component::kAlpha};
+
+// The components filters that leave alpha alone write to.
+inline constexpr std::array<Component, 3u> kColorComponents = {
+    Component::kRed, Component::kGreen, Component::kBlue};
+
+// The space filters that mix the color components of pixels do their math in.
+// Alpha is linear either way.
+enum class LightSpace : uint8_t {
+  // Directly on the sRGB-encoded components. Cheap, but blends and blurs come
+  // out darker than they should.
+  kSRGB,
+  // Components are decoded to linear light, mixed and encoded again in the
+  // same pass.
+  kLinear,
+};
+
+// How the color components of a texture relate to its alpha.
+enum class AlphaType : uint8_t {
+  // Color components are independent of alpha.
+  kStraight,
+  // Color components have already been multiplied by alpha, say by
+  // `PremultiplyAlpha`.
+  kPremultiplied,
+};
+
 class Texture {
  public:
   static std::optional<Texture> CreateFromFile(const char* name);
 
+  using ReleaseProc = std::function<void(uint8_t* allocation)>;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Wrap a planar allocation owned by the caller without copying
+  ///             it. The red, green, blue and alpha planes must be laid out
+  ///             back to back, each `size.GetArea()` bytes long.
+  ///
+  /// @param[in]  allocation    The allocation to wrap.
+  /// @param[in]  size          The size of the texture.
+  /// @param[in]  release_proc  Called with the allocation once the texture no
+  ///                           longer references it.
+  ///
+  Texture(uint8_t* allocation, UPoint size, ReleaseProc release_proc);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Wrap a planar allocation that outlives the texture. Nothing
+  ///             is released when the texture is collected.
+  ///
+  /// @param[in]  allocation  The allocation to wrap.
+  /// @param[in]  size        The size of the texture.
+  ///
+  /// @return     The borrowed texture.
+  ///
+  static Texture Borrow(uint8_t* allocation, UPoint size) {
+    return Texture(allocation, size, [](uint8_t*) {});
+  }
+
   Texture() = default;
 
-  ~Texture() { std::free(allocation_); }
+  ~Texture() = default;
 
   Texture(Texture&& other) {
     std::swap(allocation_, other.allocation_);
+    std::swap(planes_, other.planes_);
+    std::swap(size_, other.size_);
+  }
+
+  Texture& operator=(Texture&& other) {
+    std::swap(allocation_, other.allocation_);
+    std::swap(planes_, other.planes_);
     std::swap(size_, other.size_);
+    return *this;
   }
 
+  //----------------------------------------------------------------------------
+  /// @brief      Create a texture that shares all its planes with this one.
+  ///             This is cheap as no pixel data is copied. Writes to either
+  ///             texture are not visible in the other since a shared plane is
+  ///             copied the first time it is written to.
+  ///
+  /// @return     The clone.
+  ///
+  Texture Clone() const {
+    Texture clone;
+    clone.allocation_ = allocation_;
+    clone.planes_ = planes_;
+    clone.size_ = size_;
+    return clone;
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `Clone` but only for the given run of rows. Rows past
+  ///             the bottom of the texture are dropped.
+  ///
+  /// @param[in]  y     The first row.
+  /// @param[in]  rows  The number of rows.
+  ///
+  /// @return     The clone.
+  ///
+  Texture CloneRows(uint32_t y, uint32_t rows) const;
+
   size_t GetBytesPerPixel() const { return sizeof(Color); }
 
   size_t GetPixelCount() const { return size_.GetArea(); }
 
   const uint8_t* GetAllocation(Component comp = Component::kRed,
                                UPoint point = {}) const {
-    const uint8_t* allocation =
-        allocation_ + size_.GetArea() * static_cast<uint8_t>(comp);
-    return (allocation + size_.x * point.y) + point.x;
+    const auto& plane = planes_[static_cast<uint8_t>(comp)];
+    if (!plane) {
+      return nullptr;
+    }
+    return (plane.get() + static_cast<size_t>(size_.x) * point.y) + point.x;
   }
 
+  //----------------------------------------------------------------------------
+  /// @brief      Get a writable pointer into a plane. If the plane is shared
+  ///             with another component (say, after a `Swizzle` or
+  ///             `DuplicateChannel`), it is copied first so that writes only
+  ///             affect the given component.
+  ///
+  /// @return     The pointer, or `nullptr` if the plane could not be copied.
+  ///
   uint8_t* GetAllocationMutable(Component comp = Component::kRed,
                                 UPoint point = {}) {
+    if (!MakePlaneUnique(comp)) {
+      return nullptr;
+    }
     return const_cast<uint8_t*>(GetAllocation(comp, point));
   }
 
+  //----------------------------------------------------------------------------
+  /// @brief      Copy a plane that is shared with another component or texture
+  ///             so that this component has a plane of its own. The mutable
+  ///             accessors do this on their own. Calling it up front lets a
+  ///             caller fail before writing anything.
+  ///
+  /// @param[in]  comp               The component.
+  /// @param[in]  preserve_contents  Whether the new plane starts out with the
+  ///                                pixels of the shared one. Callers about
+  ///                                to write every pixel of the plane pass
+  ///                                false to skip the copy.
+  ///
+  /// @return     If the plane could be allocated. The component keeps its
+  ///             shared plane if not.
+  ///
+  bool MakePlaneUnique(Component comp, bool preserve_contents = true);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `MakePlaneUnique` for each of the given components.
+  ///
+  bool MakePlanesUnique(std::span<const Component> comps,
+                        bool preserve_contents = true);
+
   const uint8_t* GetRed(UPoint point = {}) const {
     return GetAllocation(Component::kRed, point);
   }
@@ -77,19 +209,15 @@ class Texture {
     return GetAllocationMutable(Component::kAlpha, point);
   }
 
-  bool Resize(UPoint size) {
-    if (size_ == size) {
-      return true;
-    }
-    const auto new_allocation_size = size.x * size.y * GetBytesPerPixel();
-    auto new_allocation = std::realloc(allocation_, new_allocation_size);
-    if (new_allocation == nullptr) {
-      return false;
-    }
-    allocation_ = reinterpret_cast<uint8_t*>(new_allocation);
-    size_ = size;
-    return true;
-  }
+  //----------------------------------------------------------------------------
+  /// @brief      Get an allocation of `GetPixelCount() * GetBytesPerPixel()`
+  ///             contiguous bytes, say, to copy interleaved pixels into. If
+  ///             the planes have been shuffled around since they were
+  ///             allocated, their contents are discarded.
+  ///
+  uint8_t* GetContiguousAllocationMutable();
+
+  bool Resize(UPoint size);
 
   const UPoint& GetSize() const { return size_; }
 
@@ -99,7 +227,7 @@ class Texture {
              bool clear_blue = true,
              bool clear_alpha = true);
 
-  void PremultiplyAlpha();
+  void PremultiplyAlpha(LightSpace space = LightSpace::kSRGB);
 
   void Grayscale();
 
@@ -117,6 +245,8 @@ class Texture {
 
   void Sepia();
 
+  static Matrix CreateSepiaMatrix();
+
   void Contrast(float contrast);
 
   //----------------------------------------------------------------------------
@@ -142,17 +272,61 @@ class Texture {
 
   bool CopyToRGBA(Texture& texture) const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Pack the color components into 16-bit RGB565 pixels, red in
+  ///             the most significant bits. Alpha is dropped.
+  ///
+  /// @param      rgb565  `GetPixelCount()` pixels to write to.
+  /// @param[in]  dither  Whether to apply ordered dithering. This hides the
+  ///                     banding of smooth gradients.
+  ///
+  void CopyToRGB565(uint16_t* rgb565, bool dither = false) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `CopyToRGB565` but for 8-bit RGB332 pixels.
+  ///
+  void CopyToRGB332(uint8_t* rgb332, bool dither = false) const;
+
   void Replace(const Texture& texture, Point point);
 
   float AverageLuminance() const;
 
   void LuminanceThreshold(float luminance);
 
-  bool BoxBlur(const Texture& src, uint8_t radius = 1u);
+  static std::vector<float> CreateBoxKernel(uint8_t radius);
+
+  static std::vector<float> CreateGaussianKernel(uint8_t radius, float sigma);
+
+  bool BoxBlur(const Texture& src,
+               uint8_t radius = 1u,
+               LightSpace space = LightSpace::kSRGB);
 
-  bool GaussianBlur(const Texture& src, uint8_t radius, float sigma);
+  bool GaussianBlur(const Texture& src,
+                    uint8_t radius,
+                    float sigma,
+                    LightSpace space = LightSpace::kSRGB);
 
-  bool ConvolutionNxN(const Texture& src, const std::vector<float>& kernel);
+  bool ConvolutionNxN(const Texture& src,
+                      const std::vector<float>& kernel,
+                      LightSpace space = LightSpace::kSRGB);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as the blurs and convolution above but with this texture
+  ///             being both the source and the destination. The pixels the
+  ///             kernel doesn't reach keep their values.
+  ///
+  ///             Instead of a whole second texture, each task keeps a ring of
+  ///             the last `2 * radius + 1` source rows and the rows it shares
+  ///             with its neighbors, which is O(radius × width) scratch.
+  ///
+  void BoxBlur(uint8_t radius, LightSpace space = LightSpace::kSRGB);
+
+  void GaussianBlur(uint8_t radius,
+                    float sigma,
+                    LightSpace space = LightSpace::kSRGB);
+
+  void ConvolutionNxN(const std::vector<float>& kernel,
+                      LightSpace space = LightSpace::kSRGB);
 
   bool Sobel(const Texture& src,
              Component src_component,
@@ -160,7 +334,10 @@ class Texture {
 
   void DuplicateChannel(Component src, Component dst);
 
-  bool FadeTransition(const Texture& from, const Texture& to, UnitScalarF t);
+  bool FadeTransition(const Texture& from,
+                      const Texture& to,
+                      UnitScalarF t,
+                      LightSpace space = LightSpace::kSRGB);
 
   Color AverageColor() const;
 
@@ -175,10 +352,204 @@ class Texture {
                        UnitScalarF t,
                        Direction direction);
 
+  enum class ResampleFilter {
+    kBilinear,
+    kBicubic,
+    kLanczos3,
+    kArea,
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      Scale this texture to the size of the destination. Columns
+  ///             are filtered first and then rows, each through a table of
+  ///             taps computed once per destination row and column. When
+  ///             downscaling, the filters are stretched to cover every source
+  ///             pixel. Area downscales by integer factors average whole
+  ///             blocks of pixels instead.
+  ///
+  /// @param      dst             The destination. Must be a different
+  ///                             texture. Its size picks the scale.
+  /// @param[in]  filter          The filter to resample with.
+  /// @param[in]  alpha_weighted  If the color components should be weighted
+  ///                             by alpha so that the colors of transparent
+  ///                             pixels don't bleed into opaque ones.
+  ///
+  /// @return     If the texture could be resampled.
+  ///
+  bool Resample(Texture& dst,
+                ResampleFilter filter,
+                bool alpha_weighted = false) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Build a pyramid of successively halved copies of this
+  ///             texture. Each pixel of a level is the average of a 2x2
+  ///             block of the level before. Odd sizes are rounded down and
+  ///             levels one pixel wide or tall stay that way.
+  ///
+  ///             All levels but the first are carved out of one allocation.
+  ///             They are built in tiles, with each tile reduced through
+  ///             several levels at once so that the source is only read once.
+  ///
+  /// @param[in]  levels  The number of levels, including this texture. Levels
+  ///                     past the one pixel one are dropped.
+  ///
+  /// @return     The levels, starting with a clone of this texture, or
+  ///             nothing if the texture is empty or the levels couldn't be
+  ///             allocated.
+  ///
+  std::optional<std::vector<Texture>> BuildPyramid(uint32_t levels) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Draw the source into this texture through a transform with
+  ///             bilinear sampling. Pixels of this texture whose centers map
+  ///             to outside the source keep their values.
+  ///
+  /// @param[in]  src        The source. Must be a different texture.
+  /// @param[in]  transform  Maps points of the source, in pixels, to points of
+  ///                        this texture. The source must land where the
+  ///                        transform divides by positive numbers.
+  ///
+  /// @return     If the transform could be inverted.
+  ///
+  bool Warp(const Texture& src, const Transform& transform);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sample the source at the points of a remap table with
+  ///             bilinear filtering. Pixels whose points are outside the
+  ///             source keep their values.
+  ///
+  /// @param[in]  src    The source. Must be a different texture of the size
+  ///                    the table was built for.
+  /// @param[in]  table  The table. Must be the size of this texture.
+  ///
+  /// @return     If the sizes match.
+  ///
+  bool Remap(const Texture& src, const RemapTable& table);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Write the source with its rows and columns swapped into this
+  ///             texture. Along with the rotations, this is done in square
+  ///             blocks small enough for the rows of a block to stay in the
+  ///             cache while its columns are read.
+  ///
+  /// @param[in]  src   The source. Must be a different texture. This texture
+  ///                   must be as wide as the source is tall and as tall as
+  ///                   it is wide.
+  ///
+  /// @return     If the sizes match.
+  ///
+  bool Transpose(const Texture& src);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `Transpose` but rotating the source a quarter turn
+  ///             clockwise.
+  ///
+  bool Rotate90(const Texture& src);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `Transpose` but rotating the source a quarter turn
+  ///             counterclockwise.
+  ///
+  bool Rotate270(const Texture& src);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Write the source turned upside down into this texture, which
+  ///             must be the same size but a different texture.
+  ///
+  bool Rotate180(const Texture& src);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Write the source mirrored into this texture, which must be
+  ///             the same size but a different texture. Horizontal flips
+  ///             swap left and right.
+  ///
+  bool Flip(const Texture& src, Direction direction);
+
+  // The Porter-Duff operators. Each describes how much of the source and of
+  // the destination end up in the result based on their alphas.
+  enum class CompositeMode {
+    kClear,
+    kSrc,
+    kDst,
+    kSrcOver,
+    kDstOver,
+    kSrcIn,
+    kDstIn,
+    kSrcOut,
+    kDstOut,
+    kSrcAtop,
+    kDstAtop,
+    kXor,
+    kPlus,
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      Composite the source onto this texture with its top left at
+  ///             the given point. The parts of the source outside this
+  ///             texture are clipped. Math is done in 8-bit fixed point.
+  ///
+  /// @param[in]  src         The source. Must be a different texture.
+  /// @param[in]  point       Where the top left of the source goes. May be
+  ///                         negative.
+  /// @param[in]  mode        The operator.
+  /// @param[in]  opacity     Scales the alpha of the source.
+  /// @param[in]  alpha_type  The alpha type of both textures. The result is
+  ///                         of the same type.
+  ///
+  /// @return     If the textures differ.
+  ///
+  bool Composite(const Texture& src,
+                 Point point,
+                 CompositeMode mode,
+                 UnitScalarF opacity = 1.0f,
+                 AlphaType alpha_type = AlphaType::kStraight);
+
+  // The separable blend modes of the W3C compositing spec. Each combines a
+  // color channel of the top layer with the same channel of the bottom one.
+  enum class BlendMode {
+    kNormal,
+    kMultiply,
+    kScreen,
+    kOverlay,
+    kDarken,
+    kLighten,
+    kColorDodge,
+    kColorBurn,
+    kHardLight,
+    kSoftLight,
+    kDifference,
+    kExclusion,
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      Blend the top layer onto the bottom one and composite the
+  ///             result source over. Both layers have straight alpha, as does
+  ///             the result. This texture may be either layer, which is how to
+  ///             flatten a stack of layers onto a canvas.
+  ///
+  /// @param[in]  bottom   The bottom layer.
+  /// @param[in]  top      The top layer. Must be the same size as the bottom.
+  /// @param[in]  mode     The blend mode.
+  /// @param[in]  opacity  Scales the alpha of the top layer.
+  ///
+  /// @return     If the layers are the same size and this texture could be
+  ///             resized to match.
+  ///
+  bool Blend(const Texture& bottom,
+             const Texture& top,
+             BlendMode mode,
+             UnitScalarF opacity = 1.0f);
+
  private:
-  uint8_t* allocation_ = nullptr;
+  // The block the planes were originally carved out of.
+  std::shared_ptr<uint8_t> allocation_;
+  // Indexed by component. Each plane is reference counted on its own so
+  // components can share a plane till one of them is written to.
+  std::array<std::shared_ptr<uint8_t>, 4> planes_;
   UPoint size_ = {};
 
+  void SetAllocation(std::shared_ptr<uint8_t> allocation, UPoint size);
+
   MERLE_DISALLOW_COPY_AND_ASSIGN(Texture);
 };
 
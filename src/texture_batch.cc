@@ -0,0 +1,169 @@
+#include "texture_batch.h"
+
+#include <cstring>
+
+#include "texture_ispc.h"
+
+namespace merle {
+
+static void PointFilter(Texture& texture,
+                        UPoint image_size,
+                        uint32_t image_count,
+                        ispc::PointFilter filter,
+                        const float* params = nullptr) {
+  if (!texture.MakePlanesUnique(kComponents)) {
+    return;
+  }
+  ispc::PointFilterBatch(texture.GetRedMutable(),    // reds
+                         texture.GetGreenMutable(),  // greens
+                         texture.GetBlueMutable(),   // blues
+                         texture.GetAlphaMutable(),  // alphas
+                         image_size.GetArea(),       // image size
+                         image_count,                // image count
+                         filter,                     // filter
+                         params                      // params
+  );
+}
+
+bool TextureBatch::Resize(UPoint image_size, uint32_t image_count) {
+  const uint64_t height = static_cast<uint64_t>(image_size.y) * image_count;
+  if (height > UINT32_MAX) {
+    return false;
+  }
+  if (!texture_.Resize({image_size.x, static_cast<uint32_t>(height)})) {
+    return false;
+  }
+  image_size_ = image_size;
+  image_count_ = image_count;
+  return true;
+}
+
+Texture TextureBatch::GetImage(uint32_t index) const {
+  if (index >= image_count_) {
+    return {};
+  }
+  return texture_.CloneRows(index * image_size_.y, image_size_.y);
+}
+
+bool TextureBatch::SetImage(uint32_t index, const Texture& image) {
+  if (index >= image_count_ || image.GetSize() != image_size_ ||
+      !texture_.MakePlanesUnique(kComponents)) {
+    return false;
+  }
+  const UPoint origin = {0u, index * image_size_.y};
+  for (auto comp : kComponents) {
+    ::memcpy(texture_.GetAllocationMutable(comp, origin),
+             image.GetAllocation(comp), image.GetPixelCount());
+  }
+  return true;
+}
+
+void TextureBatch::Grayscale() {
+  PointFilter(texture_, image_size_, image_count_, ispc::kPointFilterGrayscale);
+}
+
+void TextureBatch::Invert() {
+  PointFilter(texture_, image_size_, image_count_, ispc::kPointFilterInvert);
+}
+
+void TextureBatch::Exposure(float exposure) {
+  PointFilter(texture_, image_size_, image_count_, ispc::kPointFilterExposure,
+              &exposure);
+}
+
+void TextureBatch::Brightness(float brightness) {
+  PointFilter(texture_, image_size_, image_count_,
+              ispc::kPointFilterBrightness, &brightness);
+}
+
+void TextureBatch::Contrast(float contrast) {
+  PointFilter(texture_, image_size_, image_count_, ispc::kPointFilterContrast,
+              &contrast);
+}
+
+void TextureBatch::Saturation(float saturation) {
+  PointFilter(texture_, image_size_, image_count_,
+              ispc::kPointFilterSaturation, &saturation);
+}
+
+void TextureBatch::Hue(Radians hue) {
+  PointFilter(texture_, image_size_, image_count_, ispc::kPointFilterHue,
+              &hue.radians);
+}
+
+void TextureBatch::LuminanceThreshold(float luminance) {
+  PointFilter(texture_, image_size_, image_count_,
+              ispc::kPointFilterLuminanceThreshold, &luminance);
+}
+
+void TextureBatch::Opacity(UnitScalarF opacity) {
+  const float value = opacity;
+  PointFilter(texture_, image_size_, image_count_, ispc::kPointFilterOpacity,
+              &value);
+}
+
+void TextureBatch::RGBALevels(float red, float green, float blue, float alpha) {
+  const float levels[] = {red, green, blue, alpha};
+  PointFilter(texture_, image_size_, image_count_,
+              ispc::kPointFilterRGBALevels, levels);
+}
+
+void TextureBatch::ColorMatrix(const Matrix& matrix) {
+  PointFilter(texture_, image_size_, image_count_,
+              ispc::kPointFilterColorMatrix, matrix.m);
+}
+
+void TextureBatch::Sepia() {
+  ColorMatrix(Texture::CreateSepiaMatrix());
+}
+
+bool TextureBatch::BoxBlur(const TextureBatch& src, uint8_t radius) {
+  return ConvolutionNxN(src, Texture::CreateBoxKernel(radius));
+}
+
+bool TextureBatch::GaussianBlur(const TextureBatch& src,
+                                uint8_t radius,
+                                float sigma) {
+  return ConvolutionNxN(src, Texture::CreateGaussianKernel(radius, sigma));
+}
+
+bool TextureBatch::ConvolutionNxN(const TextureBatch& src,
+                                  const std::vector<float>& kernel) {
+  if (image_size_ != src.image_size_ || image_count_ != src.image_count_ ||
+      !texture_.MakePlanesUnique(kComponents)) {
+    return false;
+  }
+  ispc::ConvolutionNxNBatch(src.texture_.GetRed(),              // src r
+                            src.texture_.GetGreen(),            // src g
+                            src.texture_.GetBlue(),             // src b
+                            src.texture_.GetAlpha(),            // src a
+                            texture_.GetRedMutable(),           // dst r
+                            texture_.GetGreenMutable(),         // dst g
+                            texture_.GetBlueMutable(),          // dst b
+                            texture_.GetAlphaMutable(),         // dst a
+                            image_size_.x,                      // width
+                            image_size_.y,                      // height
+                            image_count_,                       // image count
+                            const_cast<float*>(kernel.data()),  // kernel
+                            kernel.size()                       // kernel size
+  );
+  return true;
+}
+
+bool TextureBatch::Sobel(const TextureBatch& src,
+                         Component src_component,
+                         Component dst_component) {
+  if (image_size_ != src.image_size_ || image_count_ != src.image_count_ ||
+      !texture_.MakePlaneUnique(dst_component)) {
+    return false;
+  }
+  ispc::SobelBatch(src.texture_.GetAllocation(src_component),     // src
+                   texture_.GetAllocationMutable(dst_component),  // dst
+                   image_size_.x,                                 // width
+                   image_size_.y,                                 // height
+                   image_count_                                   // count
+  );
+  return true;
+}
+
+}  // namespace merle
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "geom.h"
+#include "macros.h"
+#include "texture.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      A batch of images of the same size stored back to back in each
+///             plane of a single texture, top to bottom.
+///
+///             Running a filter on many small images one at a time is
+///             dominated by per-call overhead: a call and task launch per
+///             image and masked tails on short rows. The filters here run
+///             over the whole batch in one launch, with the images spread
+///             across tasks. Neighborhood filters don't reach across images.
+///
+class TextureBatch {
+ public:
+  TextureBatch() = default;
+
+  ~TextureBatch() = default;
+
+  TextureBatch(TextureBatch&& other) = default;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Resize the batch. The contents of the images are undefined.
+  ///
+  /// @param[in]  image_size   The size of each image.
+  /// @param[in]  image_count  The number of images.
+  ///
+  /// @return     If the batch could be allocated.
+  ///
+  bool Resize(UPoint image_size, uint32_t image_count);
+
+  const UPoint& GetImageSize() const { return image_size_; }
+
+  uint32_t GetImageCount() const { return image_count_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      The texture holding every image of the batch, one below the
+  ///             other.
+  ///
+  Texture& GetTexture() { return texture_; }
+
+  const Texture& GetTexture() const { return texture_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Get a texture that shares the pixels of an image of the batch
+  ///             without copying them. Like a `Clone`, writes to either are
+  ///             not visible in the other.
+  ///
+  Texture GetImage(uint32_t index) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Copy an image into the batch.
+  ///
+  /// @return     If the index is in the batch and the image is the size of the
+  ///             images of the batch.
+  ///
+  bool SetImage(uint32_t index, const Texture& image);
+
+  void Grayscale();
+
+  void Invert();
+
+  void Exposure(float exposure);
+
+  void Brightness(float brightness);
+
+  void Contrast(float contrast);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `Texture::Saturation` on every image.
+  ///
+  void Saturation(float saturation = 0.0f);
+
+  void Hue(Radians hue);
+
+  void LuminanceThreshold(float luminance);
+
+  void Opacity(UnitScalarF opacity);
+
+  void RGBALevels(float red, float green, float blue, float alpha);
+
+  void ColorMatrix(const Matrix& matrix);
+
+  void Sepia();
+
+  bool BoxBlur(const TextureBatch& src, uint8_t radius = 1u);
+
+  bool GaussianBlur(const TextureBatch& src, uint8_t radius, float sigma);
+
+  bool ConvolutionNxN(const TextureBatch& src,
+                      const std::vector<float>& kernel);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Same as `Texture::Sobel` on every image.
+  ///
+  bool Sobel(const TextureBatch& src,
+             Component src_component,
+             Component dst_component);
+
+ private:
+  Texture texture_;
+  UPoint image_size_ = {};
+  uint32_t image_count_ = 0u;
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(TextureBatch);
+};
+
+}  // namespace merle
@@ -0,0 +1,514 @@
+#include "tiled_texture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "texture_ispc.h"
+
+namespace merle {
+
+static constexpr size_t kTileBytes = TiledTexture::kTileArea * sizeof(Color);
+
+static void FillTile(uint8_t* tile, Color color) {
+  constexpr size_t area = TiledTexture::kTileArea;
+  ::memset(tile, color.red, area);
+  ::memset(tile + area, color.green, area);
+  ::memset(tile + area * 2, color.blue, area);
+  ::memset(tile + area * 3, color.alpha, area);
+}
+
+TiledTexture::~TiledTexture() {
+  ReleaseTiles();
+  std::free(clear_tile_);
+  std::free(allocation_);
+}
+
+TiledTexture::TiledTexture(TiledTexture&& other) {
+  std::swap(storage_, other.storage_);
+  std::swap(allocation_, other.allocation_);
+  std::swap(clear_tile_, other.clear_tile_);
+  std::swap(tiles_, other.tiles_);
+  std::swap(size_, other.size_);
+  std::swap(tile_count_, other.tile_count_);
+}
+
+bool TiledTexture::Resize(UPoint size) {
+  if (size_ == size) {
+    return true;
+  }
+  const UPoint tile_count = {(size.x + kTileSize - 1) / kTileSize,
+                             (size.y + kTileSize - 1) / kTileSize};
+  switch (storage_) {
+    case Storage::kDense: {
+      auto new_allocation =
+          std::realloc(allocation_, tile_count.GetArea() * kTileBytes);
+      if (new_allocation == nullptr) {
+        return false;
+      }
+      allocation_ = reinterpret_cast<uint8_t*>(new_allocation);
+      tiles_.resize(tile_count.GetArea());
+      for (size_t i = 0; i < tiles_.size(); i++) {
+        tiles_[i] = allocation_ + i * kTileBytes;
+      }
+    } break;
+    case Storage::kSparse:
+      if (clear_tile_ == nullptr) {
+        clear_tile_ = reinterpret_cast<uint8_t*>(std::calloc(kTileBytes, 1u));
+        if (clear_tile_ == nullptr) {
+          return false;
+        }
+      }
+      ReleaseTiles();
+      tiles_.assign(tile_count.GetArea(), clear_tile_);
+      break;
+  }
+  size_ = size;
+  tile_count_ = tile_count;
+  return true;
+}
+
+size_t TiledTexture::GetResidentTileCount() const {
+  size_t count = 0;
+  for (size_t i = 0; i < tiles_.size(); i++) {
+    count += IsTileResident(i);
+  }
+  return count;
+}
+
+uint8_t* TiledTexture::GetTileMutable(UPoint tile, Component comp) {
+  auto planes = MakeTileResident(tile.y * tile_count_.x + tile.x);
+  if (planes == nullptr) {
+    return nullptr;
+  }
+  return planes + kTileArea * static_cast<uint8_t>(comp);
+}
+
+uint8_t* TiledTexture::MakeTileResident(size_t index) {
+  if (IsTileResident(index)) {
+    return tiles_[index];
+  }
+  auto tile = reinterpret_cast<uint8_t*>(std::malloc(kTileBytes));
+  if (tile == nullptr) {
+    return nullptr;
+  }
+  ::memcpy(tile, clear_tile_, kTileBytes);
+  tiles_[index] = tile;
+  return tile;
+}
+
+bool TiledTexture::MakeAllTilesResident() {
+  for (size_t i = 0; i < tiles_.size(); i++) {
+    if (MakeTileResident(i) == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TiledTexture::ReleaseTiles() {
+  if (storage_ != Storage::kSparse) {
+    return;
+  }
+  for (auto& tile : tiles_) {
+    if (tile != clear_tile_) {
+      std::free(tile);
+      tile = clear_tile_;
+    }
+  }
+}
+
+void TiledTexture::ReleaseClearTiles() {
+  if (storage_ != Storage::kSparse) {
+    return;
+  }
+  for (auto& tile : tiles_) {
+    if (tile != clear_tile_ && ::memcmp(tile, clear_tile_, kTileBytes) == 0) {
+      std::free(tile);
+      tile = clear_tile_;
+    }
+  }
+}
+
+std::optional<std::vector<uint8_t*>> TiledTexture::GetNeighborhoodTiles(
+    const TiledTexture& src,
+    uint32_t radius) {
+  std::vector<uint8_t*> tiles(tiles_.size(), nullptr);
+  const int64_t tile_radius = (radius + kTileSize - 1) / kTileSize;
+  const int64_t tiles_x = tile_count_.x;
+  const int64_t tiles_y = tile_count_.y;
+  for (int64_t ty = 0; ty < tiles_y; ty++) {
+    for (int64_t tx = 0; tx < tiles_x; tx++) {
+      const size_t index = ty * tiles_x + tx;
+      // The filter doesn't write the pixels within the radius of the edges.
+      // Tiles that contain any of them aren't the same color throughout.
+      const int64_t left = tx * kTileSize;
+      const int64_t top = ty * kTileSize;
+      bool write = IsTileResident(index) || left < radius || top < radius ||
+                   left + kTileSize + radius > size_.x ||
+                   top + kTileSize + radius > size_.y;
+      for (int64_t ny = std::max<int64_t>(ty - tile_radius, 0);
+           !write && ny <= std::min(ty + tile_radius, tiles_y - 1); ny++) {
+        for (int64_t nx = std::max<int64_t>(tx - tile_radius, 0);
+             !write && nx <= std::min(tx + tile_radius, tiles_x - 1); nx++) {
+          write = src.IsTileResident(ny * tiles_x + nx);
+        }
+      }
+      if (!write) {
+        continue;
+      }
+      tiles[index] = MakeTileResident(index);
+      if (tiles[index] == nullptr) {
+        return std::nullopt;
+      }
+    }
+  }
+  return tiles;
+}
+
+void TiledTexture::ForEachTile(
+    const std::function<void(uint8_t* tile)>& proc) {
+  for (size_t i = 0; i < tiles_.size(); i++) {
+    if (IsTileResident(i)) {
+      proc(tiles_[i]);
+    }
+  }
+  if (clear_tile_ != nullptr) {
+    proc(clear_tile_);
+  }
+}
+
+const uint8_t** TiledTexture::GetTileTable() const {
+  return const_cast<const uint8_t**>(tiles_.data());
+}
+
+uint8_t** TiledTexture::GetTileTableMutable() {
+  return tiles_.data();
+}
+
+bool TiledTexture::CopyFromTexture(const Texture& texture) {
+  if (texture.GetSize() != size_) {
+    return false;
+  }
+  if (!MakeAllTilesResident()) {
+    return false;
+  }
+  ispc::LinearToTiled(texture.GetRed(),       // red
+                      texture.GetGreen(),     // green
+                      texture.GetBlue(),      // blue
+                      texture.GetAlpha(),     // alpha
+                      GetTileTableMutable(),  // tiles
+                      size_.x,                // width
+                      size_.y                 // height
+  );
+  ReleaseClearTiles();
+  return true;
+}
+
+bool TiledTexture::CopyToTexture(Texture& texture) const {
+  if (texture.GetSize() != size_ ||
+      !texture.MakePlanesUnique(kComponents, /*preserve_contents=*/false)) {
+    return false;
+  }
+  ispc::TiledToLinear(GetTileTable(),             // tiles
+                      texture.GetRedMutable(),    // red
+                      texture.GetGreenMutable(),  // green
+                      texture.GetBlueMutable(),   // blue
+                      texture.GetAlphaMutable(),  // alpha
+                      size_.x,                    // width
+                      size_.y                     // height
+  );
+  return true;
+}
+
+void TiledTexture::Clear(Color color) {
+  ReleaseTiles();
+  ForEachTile([color](uint8_t* tile) { FillTile(tile, color); });
+}
+
+bool TiledTexture::Replace(const Texture& texture, Point offset) {
+  Rect src_rect(offset, Size{static_cast<int32_t>(texture.GetSize().x),
+                             static_cast<int32_t>(texture.GetSize().y)});
+  const auto& dst_rect =
+      Rect{Size{static_cast<int32_t>(size_.x), static_cast<int32_t>(size_.y)}}
+          .Intersection(src_rect);
+  if (!dst_rect.has_value()) {
+    return true;
+  }
+  const int32_t tile_size = kTileSize;
+  const auto [left, top, right, bottom] = dst_rect->GetLTRB();
+  for (int32_t ty = top / tile_size; ty * tile_size < bottom; ty++) {
+    const int32_t y_begin = std::max(top, ty * tile_size);
+    const int32_t y_end = std::min(bottom, (ty + 1) * tile_size);
+    for (int32_t tx = left / tile_size; tx * tile_size < right; tx++) {
+      const int32_t x_begin = std::max(left, tx * tile_size);
+      const int32_t x_end = std::min(right, (tx + 1) * tile_size);
+      auto tile = MakeTileResident(ty * tile_count_.x + tx);
+      if (tile == nullptr) {
+        return false;
+      }
+      for (int32_t y = y_begin; y < y_end; y++) {
+        const UPoint src_point = {static_cast<uint32_t>(x_begin - offset.x),
+                                  static_cast<uint32_t>(y - offset.y)};
+        const size_t dst = (y - ty * tile_size) * tile_size +  //
+                           (x_begin - tx * tile_size);
+        for (uint8_t plane = 0; plane < 4; plane++) {
+          ::memcpy(tile + plane * kTileArea + dst,
+                   texture.GetAllocation(static_cast<Component>(plane),
+                                         src_point),
+                   x_end - x_begin);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void TiledTexture::PremultiplyAlpha() {
+  ForEachTile([](uint8_t* tile) {
+    ispc::PremultiplyAlpha(tile,                  // r
+                           tile + kTileArea,      // g
+                           tile + kTileArea * 2,  // b
+                           tile + kTileArea * 3,  // a
+                           kTileArea              // length
+    );
+  });
+}
+
+void TiledTexture::Grayscale() {
+  ForEachTile([](uint8_t* tile) {
+    ispc::Grayscale(tile,                  // red
+                    tile + kTileArea,      // green
+                    tile + kTileArea * 2,  // blue
+                    kTileArea              // length
+    );
+  });
+}
+
+void TiledTexture::Invert() {
+  ForEachTile([](uint8_t* tile) {
+    ispc::Invert(tile,                  // red
+                 tile + kTileArea,      // green
+                 tile + kTileArea * 2,  // blue
+                 kTileArea              // length
+    );
+  });
+}
+
+void TiledTexture::ColorMatrix(const Matrix& matrix) {
+  ForEachTile([&matrix](uint8_t* tile) {
+    ispc::ColorMatrix(tile,                  // red
+                      tile + kTileArea,      // green
+                      tile + kTileArea * 2,  // blue
+                      tile + kTileArea * 3,  // alpha
+                      kTileArea,             // length
+                      reinterpret_cast<const ispc::Matrix&>(matrix.e));
+  });
+}
+
+void TiledTexture::Sepia() {
+  ColorMatrix(Matrix{
+      0.3588, 0.7044, 0.1368, 0.0,  //
+      0.2990, 0.5870, 0.1140, 0.0,  //
+      0.2392, 0.4696, 0.0912, 0.0,  //
+      0, 0, 0, 1.0,                 //
+  });
+}
+
+void TiledTexture::Opacity(UnitScalarF opacity) {
+  ForEachTile([opacity](uint8_t* tile) {
+    ispc::Opacity(tile + kTileArea * 3,  // alphas
+                  kTileArea,             // length
+                  opacity                // opacity
+    );
+  });
+}
+
+Color TiledTexture::AverageColor() const {
+  const uint64_t pixel_count = static_cast<uint64_t>(size_.x) * size_.y;
+  if (pixel_count == 0) {
+    return {};
+  }
+  uint64_t sums[4] = {};
+  uint64_t resident_pixel_count = 0;
+  for (uint32_t ty = 0; ty < tile_count_.y; ty++) {
+    const uint32_t rows = std::min(kTileSize, size_.y - ty * kTileSize);
+    for (uint32_t tx = 0; tx < tile_count_.x; tx++) {
+      const size_t index = ty * tile_count_.x + tx;
+      if (!IsTileResident(index)) {
+        continue;
+      }
+      const uint32_t columns = std::min(kTileSize, size_.x - tx * kTileSize);
+      ispc::SumTiledRect(tiles_[index], columns, rows, sums);
+      resident_pixel_count += columns * rows;
+    }
+  }
+  if (clear_tile_ != nullptr) {
+    for (size_t plane = 0; plane < 4; plane++) {
+      sums[plane] += clear_tile_[plane * kTileArea] *
+                     (pixel_count - resident_pixel_count);
+    }
+  }
+  return Color{static_cast<uint8_t>(sums[0] / pixel_count),
+               static_cast<uint8_t>(sums[1] / pixel_count),
+               static_cast<uint8_t>(sums[2] / pixel_count),
+               static_cast<uint8_t>(sums[3] / pixel_count)};
+}
+
+bool TiledTexture::IsOpaque() const {
+  if (GetResidentTileCount() < tiles_.size() &&
+      clear_tile_[kTileArea * 3] != 255) {
+    return false;
+  }
+  for (uint32_t ty = 0; ty < tile_count_.y; ty++) {
+    const uint32_t rows = std::min(kTileSize, size_.y - ty * kTileSize);
+    for (uint32_t tx = 0; tx < tile_count_.x; tx++) {
+      const size_t index = ty * tile_count_.x + tx;
+      if (!IsTileResident(index)) {
+        continue;
+      }
+      const uint32_t columns = std::min(kTileSize, size_.x - tx * kTileSize);
+      if (!ispc::AllEqualTiledRect(tiles_[index] + kTileArea * 3,  // alpha
+                                   columns,                         // columns
+                                   rows,                            // rows
+                                   255                              // value
+                                   )) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool TiledTexture::BoxBlur(const TiledTexture& src, uint8_t radius) {
+  return ConvolutionNxN(src, Texture::CreateBoxKernel(radius));
+}
+
+bool TiledTexture::GaussianBlur(const TiledTexture& src,
+                                uint8_t radius,
+                                float sigma) {
+  return ConvolutionNxN(src, Texture::CreateGaussianKernel(radius, sigma));
+}
+
+// Tiles of a sparse destination that only see the clear tile of the source
+// all end up the same color. Filter just enough of the clear tile for the
+// center pixel to be written and copy it to every pixel of the clear tile of
+// the destination.
+template <class FilterProc>
+static void FilterClearTile(const uint8_t* src_clear_tile,
+                            uint8_t* dst_clear_tile,
+                            uint32_t radius,
+                            uint8_t first_plane,
+                            uint8_t last_plane,
+                            const FilterProc& filter) {
+  const uint32_t size = radius * 2 + 1;
+  const uint32_t tiles =
+      (size + TiledTexture::kTileSize - 1) / TiledTexture::kTileSize;
+  std::vector<const uint8_t*> src_tiles(tiles * tiles, src_clear_tile);
+  std::vector<uint8_t> scratch(kTileBytes);
+  std::vector<uint8_t*> dst_tiles(tiles * tiles, scratch.data());
+  filter(src_tiles.data(), dst_tiles.data(), size);
+  const size_t center = (radius % TiledTexture::kTileSize) *
+                            (TiledTexture::kTileSize + 1);
+  for (uint8_t plane = first_plane; plane <= last_plane; plane++) {
+    ::memset(dst_clear_tile + plane * TiledTexture::kTileArea,
+             scratch[plane * TiledTexture::kTileArea + center],
+             TiledTexture::kTileArea);
+  }
+}
+
+bool TiledTexture::ConvolutionNxN(const TiledTexture& src,
+                                  const std::vector<float>& kernel) {
+  if (size_ != src.size_) {
+    return false;
+  }
+  const uint32_t radius =
+      (static_cast<uint32_t>(std::sqrt(kernel.size())) - 1u) / 2u;
+  auto dst_tiles = GetNeighborhoodTiles(src, radius);
+  if (!dst_tiles.has_value()) {
+    return false;
+  }
+  ispc::ConvolutionNxNTiled(src.GetTileTable(),                 // src
+                            dst_tiles->data(),                  // dst
+                            size_.x,                            // width
+                            size_.y,                            // height
+                            const_cast<float*>(kernel.data()),  // kernel
+                            kernel.size()                       // kernel size
+  );
+  if (GetResidentTileCount() < tiles_.size()) {
+    FilterClearTile(
+        src.clear_tile_, clear_tile_, radius, 0u, 3u,
+        [&kernel](const uint8_t** src_tiles, uint8_t** dst_tiles,
+                  uint32_t size) {
+          ispc::ConvolutionNxNTiled(src_tiles, dst_tiles, size, size,
+                                    const_cast<float*>(kernel.data()),
+                                    kernel.size());
+        });
+  }
+  return true;
+}
+
+bool TiledTexture::Sobel(const TiledTexture& src,
+                         Component src_component,
+                         Component dst_component) {
+  if (size_ != src.size_) {
+    return false;
+  }
+  auto dst_tiles = GetNeighborhoodTiles(src, 1u);
+  if (!dst_tiles.has_value()) {
+    return false;
+  }
+  const auto src_plane = static_cast<uint8_t>(src_component);
+  const auto dst_plane = static_cast<uint8_t>(dst_component);
+  ispc::SobelTiled(src.GetTileTable(),  // src
+                   src_plane,           // src plane
+                   dst_tiles->data(),   // dst
+                   dst_plane,           // dst plane
+                   size_.x,             // width
+                   size_.y              // height
+  );
+  if (GetResidentTileCount() < tiles_.size()) {
+    FilterClearTile(
+        src.clear_tile_, clear_tile_, 1u, dst_plane, dst_plane,
+        [&](const uint8_t** src_tiles, uint8_t** dst_tiles, uint32_t size) {
+          ispc::SobelTiled(src_tiles, src_plane, dst_tiles, dst_plane, size,
+                           size);
+        });
+  }
+  return true;
+}
+
+bool TiledTexture::SwipeTransition(const TiledTexture& from,
+                                   const TiledTexture& to,
+                                   UnitScalarF t,
+                                   Texture::Direction direction) {
+  if (from.size_ != to.size_ || size_ != from.size_) {
+    return false;
+  }
+  if (!MakeAllTilesResident()) {
+    return false;
+  }
+  int64_t x_break = std::numeric_limits<int64_t>::max();
+  int64_t y_break = std::numeric_limits<int64_t>::max();
+  switch (direction) {
+    case Texture::Direction::kHorizontal:
+      x_break = size_.x * t;
+      break;
+    case Texture::Direction::kVertical:
+      y_break = size_.y * t;
+      break;
+  }
+  ispc::SwipeTransitionTiled(GetTileTableMutable(),  // dst
+                             from.GetTileTable(),    // from
+                             to.GetTileTable(),      // to
+                             size_.x,                // width
+                             size_.y,                // height
+                             x_break,                // x break
+                             y_break                 // y break
+  );
+  return true;
+}
+
+}  // namespace merle
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "geom.h"
+#include "macros.h"
+#include "texture.h"
+
+namespace merle {
+
+//------------------------------------------------------------------------------
+/// @brief      A texture stored as square tiles. Each tile holds the red,
+///             green, blue and alpha planes of a `kTileSize` square block of
+///             pixels back to back.
+///
+///             Unlike a `Texture`, pixels in adjacent rows are never more than
+///             a tile row apart. Neighborhood filters work on one tile (plus
+///             the few rows and columns they reach into from its neighbors) at
+///             a time and don't thrash the cache on wide images.
+///
+///             Sparse textures only allocate tiles once they are written to.
+///             Tiles that haven't been written to all refer to one shared tile
+///             filled with the clear color. Point filters and reductions only
+///             visit the allocated tiles and the shared tile, so their cost is
+///             proportional to the occupied area rather than the canvas size.
+///
+class TiledTexture {
+ public:
+  static constexpr uint32_t kTileSize = 64u;
+
+  static constexpr size_t kTileArea = kTileSize * kTileSize;
+
+  enum class Storage {
+    // All tiles live in a single allocation made when the texture is resized.
+    kDense,
+    // Tiles are allocated on first write.
+    kSparse,
+  };
+
+  explicit TiledTexture(Storage storage = Storage::kDense)
+      : storage_(storage) {}
+
+  ~TiledTexture();
+
+  TiledTexture(TiledTexture&& other);
+
+  bool Resize(UPoint size);
+
+  const UPoint& GetSize() const { return size_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      The number of tiles in each direction. Tiles on the right and
+  ///             bottom edges may only be partially covered by the texture.
+  ///
+  const UPoint& GetTileCount() const { return tile_count_; }
+
+  Storage GetStorage() const { return storage_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Whether the tile has its own allocation. Always true for dense
+  ///             textures.
+  ///
+  bool IsTileResident(UPoint tile) const {
+    return IsTileResident(tile.y * tile_count_.x + tile.x);
+  }
+
+  size_t GetResidentTileCount() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      The plane of a tile. Tiles of sparse textures that haven't
+  ///             been written to return the shared clear tile.
+  ///
+  const uint8_t* GetTile(UPoint tile, Component comp = Component::kRed) const {
+    return tiles_[tile.y * tile_count_.x + tile.x] +
+           kTileArea * static_cast<uint8_t>(comp);
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      The plane of a tile for writing. In sparse textures, this
+  ///             allocates the tile if necessary.
+  ///
+  /// @return     The plane or null if the tile could not be allocated.
+  ///
+  uint8_t* GetTileMutable(UPoint tile, Component comp = Component::kRed);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Copy the texture into this one. Sparse textures only keep the
+  ///             tiles that don't end up entirely the clear color.
+  ///
+  bool CopyFromTexture(const Texture& texture);
+
+  bool CopyToTexture(Texture& texture) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Fill the texture with a color. This releases all the tiles of
+  ///             a sparse texture and makes the color its clear color.
+  ///
+  void Clear(Color color);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Release the tiles of a sparse texture that are entirely the
+  ///             clear color.
+  ///
+  void ReleaseClearTiles();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Copy a texture into this one with its top left corner at the
+  ///             given offset. Only the tiles it covers are allocated.
+  ///
+  /// @return     If the covered tiles could be allocated.
+  ///
+  bool Replace(const Texture& texture, Point offset);
+
+  void PremultiplyAlpha();
+
+  void Grayscale();
+
+  void Invert();
+
+  void ColorMatrix(const Matrix& matrix);
+
+  void Sepia();
+
+  void Opacity(UnitScalarF opacity);
+
+  Color AverageColor() const;
+
+  bool IsOpaque() const;
+
+  bool BoxBlur(const TiledTexture& src, uint8_t radius = 1u);
+
+  bool GaussianBlur(const TiledTexture& src, uint8_t radius, float sigma);
+
+  bool ConvolutionNxN(const TiledTexture& src,
+                      const std::vector<float>& kernel);
+
+  bool Sobel(const TiledTexture& src,
+             Component src_component,
+             Component dst_component);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Blend between two textures. This allocates every tile of a
+  ///             sparse texture.
+  ///
+  bool SwipeTransition(const TiledTexture& from,
+                       const TiledTexture& to,
+                       UnitScalarF t,
+                       Texture::Direction direction);
+
+ private:
+  Storage storage_ = Storage::kDense;
+  // Only used by dense textures.
+  uint8_t* allocation_ = nullptr;
+  // Only used by sparse textures. Shared by all tiles without an allocation.
+  uint8_t* clear_tile_ = nullptr;
+  // Row major. Each entry points to the planes of a tile.
+  std::vector<uint8_t*> tiles_;
+  UPoint size_ = {};
+  UPoint tile_count_ = {};
+
+  bool IsTileResident(size_t index) const {
+    return tiles_[index] != clear_tile_;
+  }
+
+  uint8_t* MakeTileResident(size_t index);
+
+  bool MakeAllTilesResident();
+
+  void ReleaseTiles();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Allocate the tiles a neighborhood filter reading from `src`
+  ///             must write to. Tiles of a sparse texture are left alone if
+  ///             they aren't resident, don't touch the unfiltered border and
+  ///             are at least `radius` away from any resident tile of `src`.
+  ///             Their filtered value is the same everywhere and is written to
+  ///             the clear tile instead.
+  ///
+  /// @return     The table of tiles to write to, null for the ones to skip. Or
+  ///             nothing if the tiles could not be allocated.
+  ///
+  std::optional<std::vector<uint8_t*>> GetNeighborhoodTiles(
+      const TiledTexture& src,
+      uint32_t radius);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Call the proc with every resident tile followed by the clear
+  ///             tile of a sparse texture.
+  ///
+  void ForEachTile(const std::function<void(uint8_t* tile)>& proc);
+
+  const uint8_t** GetTileTable() const;
+
+  uint8_t** GetTileTableMutable();
+
+  MERLE_DISALLOW_COPY_AND_ASSIGN(TiledTexture);
+};
+
+}  // namespace merle